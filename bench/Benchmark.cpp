@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <algorithm>
+#include <cstdio>
+
+BenchmarkRunner::BenchmarkRunner()
+    : m_minSampleNs(100000000), m_samples(10)
+{
+}
+
+void BenchmarkRunner::add(const QString &name, Body body)
+{
+    m_benchmarks.push_back({ name, std::move(body) });
+}
+
+void BenchmarkRunner::addOnce(const QString &name, Body body)
+{
+    m_benchmarks.push_back({ name, std::move(body), true });
+}
+
+QStringList BenchmarkRunner::names() const
+{
+    QStringList list;
+    for (const Entry &entry : m_benchmarks) {
+        list << entry.name;
+    }
+    return list;
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(const QString &filter) const
+{
+    std::vector<BenchmarkResult> results;
+    for (const Entry &entry : m_benchmarks) {
+        if (!filter.isEmpty() && !entry.name.contains(filter)) {
+            continue;
+        }
+        
+        BenchmarkResult result = measure(entry);
+        std::fprintf(stderr, "%-40s %14.1f ns/op  (%lld iterations x %d)\n",
+                     qPrintable(result.name), result.medianNs,
+                     static_cast<long long>(result.iterations), result.samples);
+        results.push_back(result);
+    }
+    return results;
+}
+
+BenchmarkResult BenchmarkRunner::measure(const Entry &entry) const
+{
+    if (entry.once) {
+        BenchmarkContext context(1);
+        entry.body(context);
+        
+        BenchmarkResult result;
+        result.name = entry.name;
+        result.iterations = 1;
+        result.samples = 1;
+        result.minNs = result.medianNs = result.meanNs = result.maxNs = static_cast<double>(context.elapsed());
+        return result;
+    }
+    
+    // Grow the iteration count until a sample is long enough to time reliably
+    qint64 iterations = 1;
+    for (;;) {
+        BenchmarkContext context(iterations);
+        entry.body(context);
+        const qint64 elapsed = qMax<qint64>(context.elapsed(), 1);
+        if (elapsed >= m_minSampleNs || iterations >= (qint64(1) << 40)) {
+            break;
+        }
+        
+        const double scale = 1.4 * m_minSampleNs / elapsed;
+        iterations = static_cast<qint64>(iterations * std::clamp(scale, 2.0, 100.0));
+    }
+    
+    std::vector<double> perIteration;
+    perIteration.reserve(m_samples);
+    for (int sample = 0; sample < m_samples; ++sample) {
+        BenchmarkContext context(iterations);
+        entry.body(context);
+        perIteration.push_back(static_cast<double>(context.elapsed()) / iterations);
+    }
+    std::sort(perIteration.begin(), perIteration.end());
+    
+    BenchmarkResult result;
+    result.name = entry.name;
+    result.iterations = iterations;
+    result.samples = m_samples;
+    result.minNs = perIteration.front();
+    result.maxNs = perIteration.back();
+    
+    const size_t middle = perIteration.size() / 2;
+    result.medianNs = perIteration.size() % 2
+                          ? perIteration[middle]
+                          : (perIteration[middle - 1] + perIteration[middle]) / 2.0;
+    
+    double sum = 0.0;
+    for (double value : perIteration) {
+        sum += value;
+    }
+    result.meanNs = sum / perIteration.size();
+    return result;
+}
+
+QByteArray BenchmarkRunner::toJson(const std::vector<BenchmarkResult> &results)
+{
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    context["qtVersion"] = QString::fromLatin1(qVersion());
+    context["cpu"] = QSysInfo::currentCpuArchitecture();
+    context["os"] = QSysInfo::prettyProductName();
+    
+    QJsonArray benchmarks;
+    for (const BenchmarkResult &result : results) {
+        QJsonObject object;
+        object["name"] = result.name;
+        object["iterations"] = result.iterations;
+        object["samples"] = result.samples;
+        object["minNs"] = result.minNs;
+        object["medianNs"] = result.medianNs;
+        object["meanNs"] = result.meanNs;
+        object["maxNs"] = result.maxNs;
+        benchmarks.append(object);
+    }
+    
+    QJsonObject root;
+    root["context"] = context;
+    root["benchmarks"] = benchmarks;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
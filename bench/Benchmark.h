@@ -0,0 +1,79 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+// Handed to every benchmark body. The body runs the measured operation
+// iterations() times; only time between startTiming() and stopTiming() is
+// counted, so setup and teardown can sit outside it (or be excluded
+// mid-loop by stopping and restarting).
+class BenchmarkContext
+{
+public:
+    explicit BenchmarkContext(qint64 iterations) : m_iterations(iterations), m_elapsed(0) {}
+    
+    qint64 iterations() const { return m_iterations; }
+    void startTiming() { m_timer.start(); }
+    void stopTiming() { m_elapsed += m_timer.nsecsElapsed(); }
+    qint64 elapsed() const { return m_elapsed; }
+
+private:
+    qint64 m_iterations;
+    qint64 m_elapsed;
+    QElapsedTimer m_timer;
+};
+
+struct BenchmarkResult
+{
+    QString name;
+    qint64 iterations = 0;  // Per sample
+    int samples = 0;
+    double minNs = 0.0;     // Per iteration
+    double medianNs = 0.0;
+    double meanNs = 0.0;
+    double maxNs = 0.0;
+};
+
+// Runs registered benchmarks: the iteration count is first grown until one
+// sample takes at least the minimum sample time, then that many iterations
+// are timed samples() times and summarised per iteration.
+class BenchmarkRunner
+{
+public:
+    using Body = std::function<void(BenchmarkContext &)>;
+    
+    BenchmarkRunner();
+    
+    void add(const QString &name, Body body);
+    // Runs body once with a single iteration: for costs only the first call
+    // in the process pays, such as a cold start
+    void addOnce(const QString &name, Body body);
+    void setMinSampleTime(qint64 milliseconds) { m_minSampleNs = milliseconds * 1000000; }
+    void setSamples(int samples) { m_samples = qMax(1, samples); }
+    
+    QStringList names() const;
+    std::vector<BenchmarkResult> run(const QString &filter) const;
+    
+    // Results plus enough context (Qt version, CPU, OS) to tell runs apart
+    static QByteArray toJson(const std::vector<BenchmarkResult> &results);
+
+private:
+    struct Entry
+    {
+        QString name;
+        Body body;
+        bool once = false;
+    };
+    
+    BenchmarkResult measure(const Entry &entry) const;
+    
+    std::vector<Entry> m_benchmarks;
+    qint64 m_minSampleNs;
+    int m_samples;
+};
+
+#endif
@@ -0,0 +1,544 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThreadPool>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "Benchmark.h"
+#include "BrickGrid.h"
+#include "FrameCapture.h"
+#include "GameScene.h"
+#include "GameWorld.h"
+#include "HighScoreManager.h"
+#include "Level.h"
+#include "LevelManager.h"
+#include "PaddleController.h"
+#include "ParticleSystem.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "Replay.h"
+
+namespace {
+
+// Held to --frame-budget
+const char *const FRAME_BUDGET_BENCHMARK = "collision/bricks=60/balls=10000";
+const char *const REPLAY_BENCHMARK = "replay/run/seconds=60";
+const char *const POWER_UP_SOAK_BENCHMARK = "soak/powerups/ticks=432000";
+
+// The most a brick holds; 10,000 balls take a few hundred hits a tick, and
+// at this many no brick breaks between world rebuilds, so the level is never
+// cleared and the workload stays constant
+constexpr int UNBREAKABLE_HIT_POINTS = 0x7fff;
+
+// Writes a level of full ten-brick rows
+QString writeLevel(const QTemporaryDir &dir, int rows, int hitPoints)
+{
+    QJsonArray bricks;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < GameWorld::BRICK_COLUMNS; ++col) {
+            QJsonObject brick;
+            brick["row"] = row;
+            brick["col"] = col;
+            brick["color"] = "#FF6464";
+            brick["hitPoints"] = hitPoints;
+            bricks.append(brick);
+        }
+    }
+    
+    QJsonObject level;
+    level["levelNumber"] = 1;
+    level["name"] = QString("Bench %1 rows").arg(rows);
+    level["ballSpeed"] = 300.0;
+    level["bricks"] = bricks;
+    
+    const QString path = dir.filePath(QString("bench-%1-%2.json").arg(rows).arg(hitPoints));
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(level).toJson());
+    }
+    return path;
+}
+
+// A user level pack of count five-row levels
+QString writePack(const QTemporaryDir &dir, int count)
+{
+    const QString path = dir.filePath(QString("pack-%1").arg(count));
+    QDir().mkpath(path);
+    
+    QJsonArray bricks;
+    for (int row = 0; row < 5; ++row) {
+        for (int col = 0; col < GameWorld::BRICK_COLUMNS; ++col) {
+            QJsonObject brick;
+            brick["row"] = row;
+            brick["col"] = col;
+            brick["color"] = "#6464FF";
+            brick["hitPoints"] = 1 + row % 3;
+            bricks.append(brick);
+        }
+    }
+    
+    for (int i = 1; i <= count; ++i) {
+        QJsonObject level;
+        level["levelNumber"] = i;
+        level["name"] = QString("Pack level %1").arg(i);
+        level["ballSpeed"] = 250.0;
+        level["bricks"] = bricks;
+        
+        QFile file(QDir(path).filePath(QString("level%1.json").arg(i)));
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(level).toJson());
+        }
+    }
+    return path;
+}
+
+// Tops the world up to balls balls, scattered below the bricks
+void fillBalls(GameWorld &world, Random &random, int balls)
+{
+    while (world.balls().size() < balls) {
+        const qreal angle = random.uniform(0.0, 2.0 * M_PI);
+        world.spawnBall(random.uniform(20.0, GameWorld::WIDTH - 20.0), random.uniform(60.0, 450.0),
+                        std::cos(angle) * 300.0, std::sin(angle) * 300.0);
+    }
+}
+
+// World with the level loaded and extra balls scattered below the bricks
+void setUpWorld(GameWorld &world, const Level &level, int balls)
+{
+    Random random(balls);
+    world.newGame(1);
+    world.loadLevel(level);
+    fillBalls(world, random, balls);
+}
+
+// With profiled set, ScopedTimer spans are recorded as in the game, which
+// prices the instrumentation against the same case without it. A step that
+// starts with fewer than balls balls, or in a world no longer playing, sets
+// countShort.
+void addCollisionBenchmark(BenchmarkRunner &runner, const std::shared_ptr<Level> &level, int rows, int balls,
+                           bool &countShort, bool profiled = false)
+{
+    runner.add(QString("collision/bricks=%1/balls=%2%3").arg(rows * GameWorld::BRICK_COLUMNS).arg(balls)
+                   .arg(profiled ? "/profiler=on" : ""),
+               [level, balls, profiled, &countShort](BenchmarkContext &context) {
+        Profiler::instance().setEnabled(profiled);
+        // The floor is open, so balls that drain are replaced (untimed) after
+        // the step that lost them and every step moves the full count. The
+        // world is still rebuilt every two seconds of game time, so lives lost
+        // with the last ball never end the game.
+        constexpr int STEPS_PER_WORLD = 240;
+        GameWorld world;
+        PaddleInput input;
+        Random refills(balls + 1);
+        for (qint64 done = 0; done < context.iterations(); ) {
+            setUpWorld(world, *level, balls);
+            const qint64 steps = qMin<qint64>(STEPS_PER_WORLD, context.iterations() - done);
+            context.startTiming();
+            for (qint64 i = 0; i < steps; ++i) {
+                world.step(input);
+                if (world.balls().size() != balls) {
+                    context.stopTiming();
+                    fillBalls(world, refills, balls);
+                    context.startTiming();
+                }
+                if (world.balls().size() != balls || world.state() != WorldState::Playing) {
+                    countShort = true;
+                }
+            }
+            context.stopTiming();
+            done += steps;
+        }
+        Profiler::instance().setEnabled(false);
+    });
+}
+
+// Same workload as the collision cases with the autopilot steering; the
+// difference to collision/bricks=60 is the controller's cost per tick
+void addAutopilotBenchmark(BenchmarkRunner &runner, const std::shared_ptr<Level> &level, int balls)
+{
+    runner.add(QString("controller/autopilot/balls=%1").arg(balls), [level, balls](BenchmarkContext &context) {
+        constexpr int STEPS_PER_WORLD = 240;
+        GameWorld world;
+        Autopilot autopilot;
+        for (qint64 done = 0; done < context.iterations(); ) {
+            setUpWorld(world, *level, balls);
+            autopilot.reset();
+            const qint64 steps = qMin<qint64>(STEPS_PER_WORLD, context.iterations() - done);
+            context.startTiming();
+            for (qint64 i = 0; i < steps; ++i) {
+                world.step(autopilot.update(world));
+            }
+            context.stopTiming();
+            done += steps;
+        }
+    });
+}
+
+// A game of one level played by the autopilot, recorded the way the game
+// records the player
+std::shared_ptr<const Replay> recordGame(const std::shared_ptr<const Level> &level, quint32 seed, quint64 maxTicks)
+{
+    auto replay = std::make_shared<Replay>();
+    GameWorld world;
+    Autopilot autopilot;
+    world.newGame(seed);
+    replay->begin(seed, world.tickRate());
+    replay->recordLevel(world.tick(), 1);
+    world.loadLevel(*level);
+    while (world.state() == WorldState::Playing && world.tick() < maxTicks) {
+        const PaddleInput input = autopilot.update(world);
+        replay->recordInput(world.tick(), input);
+        world.step(input);
+    }
+    replay->finish(world.tick(), world.stateHash());
+    return replay;
+}
+
+void settle(int milliseconds)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < milliseconds) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Render benchmarks paint into a QImage; no window needs to be shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    
+    // Keep QSettings (level progress) away from the player's own; applies
+    // wherever the settings backend is file based
+    QStandardPaths::setTestModeEnabled(true);
+    
+    // Level loading logs every call; keep that out of the results
+    QLoggingCategory::setFilterRules("default.debug=false");
+    
+    // The profiler is on by default for the game; measurements are taken
+    // without it unless a case says otherwise
+    Profiler::instance().setEnabled(false);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Qt Arkanoid microbenchmarks");
+    parser.addHelpOption();
+    QCommandLineOption filterOption("filter", "Only run benchmarks whose name contains <text>.", "text");
+    QCommandLineOption outputOption("output", "Write JSON results to <file> instead of stdout.", "file");
+    QCommandLineOption minTimeOption("min-time", "Minimum time per sample in milliseconds.", "ms", "100");
+    QCommandLineOption samplesOption("samples", "Samples per benchmark.", "count", "10");
+    QCommandLineOption listOption("list", "List benchmark names and exit.");
+    QCommandLineOption frameBudgetOption("frame-budget",
+                                         QString("Fail if %1 takes longer than <ms> per 60 Hz frame (0 = no check).")
+                                             .arg(FRAME_BUDGET_BENCHMARK), "ms", "16.7");
+    parser.addOptions({ filterOption, outputOption, minTimeOption, samplesOption, listOption, frameBudgetOption });
+    parser.process(app);
+    
+    QTemporaryDir dataDir;
+    if (!dataDir.isValid()) {
+        std::fprintf(stderr, "Could not create a temporary directory\n");
+        return 1;
+    }
+    
+    BenchmarkRunner runner;
+    runner.setMinSampleTime(parser.value(minTimeOption).toLongLong());
+    runner.setSamples(parser.value(samplesOption).toInt());
+    
+    // Broad phase scaling with brick count, then ball count at a fixed grid
+    // up to the 10k-ball stress case
+    bool countShort = false;
+    for (int rows : { 2, 6, 14 }) {
+        auto level = std::make_shared<Level>();
+        level->loadFromJson(writeLevel(dataDir, rows, UNBREAKABLE_HIT_POINTS));
+        addCollisionBenchmark(runner, level, rows, 64, countShort);
+        if (rows == 6) {
+            addCollisionBenchmark(runner, level, rows, 64, countShort, true);
+            for (int balls : { 1, 1024, 10000 }) {
+                addCollisionBenchmark(runner, level, rows, balls, countShort);
+            }
+            for (int balls : { 1, 64 }) {
+                addAutopilotBenchmark(runner, level, balls);
+            }
+        }
+    }
+    
+    // The broad phase on its own, on fields far larger than a level can hold;
+    // one iteration is one ball-sized query, so the time is per query and
+    // should stay flat as the field grows
+    for (int count : { 1000, 10000, 50000 }) {
+        runner.add(QString("grid/query/bricks=%1").arg(count), [count](BenchmarkContext &context) {
+            constexpr int COLUMNS = 50;
+            constexpr qreal PITCH_X = GameWorld::BRICK_WIDTH + GameWorld::BRICK_PADDING;
+            constexpr qreal PITCH_Y = GameWorld::BRICK_HEIGHT + GameWorld::BRICK_PADDING;
+            std::vector<QRectF> bricks;
+            bricks.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                bricks.emplace_back((i % COLUMNS) * PITCH_X, (i / COLUMNS) * PITCH_Y,
+                                    GameWorld::BRICK_WIDTH, GameWorld::BRICK_HEIGHT);
+            }
+            BrickGrid grid;
+            grid.build(bricks, PITCH_X, PITCH_Y);
+            
+            // A ball swept over one tick at a fast ball speed
+            constexpr int QUERIES = 1024;
+            constexpr qreal SIZE = 2.0 * GameWorld::BALL_RADIUS + 600.0 / GameWorld::DEFAULT_TICK_RATE;
+            const QRectF bounds = grid.bounds();
+            Random random(count);
+            std::vector<QRectF> areas;
+            areas.reserve(QUERIES);
+            for (int i = 0; i < QUERIES; ++i) {
+                areas.emplace_back(random.uniform(bounds.left(), bounds.right() - SIZE),
+                                   random.uniform(bounds.top(), bounds.bottom() - SIZE), SIZE, SIZE);
+            }
+            
+            std::vector<int> candidates;
+            context.startTiming();
+            for (qint64 i = 0; i < context.iterations(); ++i) {
+                candidates.clear();
+                grid.query(areas[i % QUERIES], candidates);
+            }
+            context.stopTiming();
+        });
+    }
+    
+    for (int count : { 500, 2000, 20000 }) {
+        runner.add(QString("particles/update/count=%1").arg(count), [count](BenchmarkContext &context) {
+            Random random(count);
+            ParticleSystem particles(count);
+            for (int i = 0; i < count; ++i) {
+                particles.spawn(random.uniform(0.0, 800.0), random.uniform(0.0, 600.0),
+                                random.uniform(-200.0, 200.0), random.uniform(-300.0, 0.0),
+                                QColor(255, 100, 100), 1.0e9);
+            }
+            context.startTiming();
+            for (qint64 i = 0; i < context.iterations(); ++i) {
+                particles.update(1.0 / GameWorld::DEFAULT_TICK_RATE);
+            }
+            context.stopTiming();
+        });
+    }
+    
+    for (int rows : { 5, 80 }) {
+        const QString path = writeLevel(dataDir, rows, 1);
+        runner.add(QString("level/loadFromJson/bricks=%1").arg(rows * GameWorld::BRICK_COLUMNS),
+                   [path](BenchmarkContext &context) {
+            context.startTiming();
+            for (qint64 i = 0; i < context.iterations(); ++i) {
+                Level level;
+                level.loadFromJson(path);
+            }
+            context.stopTiming();
+        });
+    }
+    
+    // Startup cost of indexing a large user pack, on the whole pool and on
+    // one thread for comparison. The cold case is the first pack index in
+    // the process, which also starts the pool's threads; the files were just
+    // written, so they are read from the page cache either way.
+    const QString pack = writePack(dataDir, 1000);
+    runner.addOnce("levels/loadLevels/pack=1000/cold", [pack](BenchmarkContext &context) {
+        context.startTiming();
+        LevelManager levels;
+        levels.addPackDirectory(pack);
+        levels.loadLevels();
+        context.stopTiming();
+    });
+    for (int threads : { 0, 1 }) {
+        runner.add(QString("levels/loadLevels/pack=1000/threads=%1").arg(threads ? QString::number(threads) : "all"),
+                   [pack, threads](BenchmarkContext &context) {
+            const int maxThreads = QThreadPool::globalInstance()->maxThreadCount();
+            if (threads) {
+                QThreadPool::globalInstance()->setMaxThreadCount(threads);
+            }
+            context.startTiming();
+            for (qint64 i = 0; i < context.iterations(); ++i) {
+                LevelManager levels;
+                levels.addPackDirectory(pack);
+                levels.loadLevels();
+            }
+            context.stopTiming();
+            QThreadPool::globalInstance()->setMaxThreadCount(maxThreads);
+        });
+    }
+    
+    // Headless playback of a recorded minute of play; every run must end in
+    // the recorded state, or the bench fails
+    auto replayLevel = std::make_shared<Level>();
+    replayLevel->loadFromJson(writeLevel(dataDir, 6, 2));
+    bool replayDiverged = false;
+    runner.add(REPLAY_BENCHMARK, [replayLevel, &replayDiverged](BenchmarkContext &context) {
+        const std::shared_ptr<const Replay> replay = recordGame(replayLevel, 1, 60 * GameWorld::DEFAULT_TICK_RATE);
+        GameWorld world;
+        for (qint64 i = 0; i < context.iterations(); ++i) {
+            ReplayPlayer player(replay, [replayLevel](int) { return replayLevel; });
+            context.startTiming();
+            player.start(world);
+            player.run(world);
+            context.stopTiming();
+            if (!player.matches(world)) {
+                replayDiverged = true;
+            }
+        }
+    });
+    
+    // The table goes to an INI file in the temporary directory; test mode
+    // does not redirect the registry on Windows
+    const QString highScoreFile = dataDir.filePath("highscores.ini");
+    // An hour of game time with a power-up forced every ten ticks on top of
+    // the normal drops; the pool must stay inside the slots it started with.
+    // Extra balls are topped up so the game never ends.
+    bool poolGrew = false;
+    runner.addOnce(POWER_UP_SOAK_BENCHMARK, [replayLevel, &poolGrew](BenchmarkContext &context) {
+        constexpr quint64 TICKS = 3600ull * GameWorld::DEFAULT_TICK_RATE;
+        constexpr int DROP_INTERVAL = 10;
+        constexpr int BALLS = 8;
+        GameWorld world;
+        Autopilot autopilot;
+        Random random(TICKS);
+        world.newGame(1);
+        world.loadLevel(*replayLevel);
+        int peak = 0;
+        context.startTiming();
+        for (quint64 tick = 0; tick < TICKS && !poolGrew; ++tick) {
+            if (world.state() != WorldState::Playing) {
+                world.loadLevel(*replayLevel);
+            }
+            if (tick % DROP_INTERVAL == 0) {
+                world.dropPowerUp(random.uniform(20.0, GameWorld::WIDTH - 20.0), 100.0,
+                                  static_cast<PowerUpType>(random.bounded(PowerUp::TYPE_COUNT)));
+            }
+            fillBalls(world, random, BALLS);
+            world.step(autopilot.update(world));
+            world.clearEvents();
+            
+            const PowerUpPool &pool = world.powerUps();
+            peak = qMax(peak, pool.size());
+            if (pool.capacity() > PowerUpPool::DEFAULT_CAPACITY || pool.size() > pool.capacity()) {
+                std::fprintf(stderr, "%s: %d live power-ups in %d slots at tick %llu\n", POWER_UP_SOAK_BENCHMARK,
+                             pool.size(), pool.capacity(), static_cast<unsigned long long>(tick));
+                poolGrew = true;
+            }
+        }
+        context.stopTiming();
+        std::fprintf(stderr, "%s: at most %d of %d slots live\n", POWER_UP_SOAK_BENCHMARK, peak,
+                     world.powerUps().capacity());
+    });
+    
+    runner.add("highscores/addHighScore", [highScoreFile](BenchmarkContext &context) {
+        HighScoreManager manager(highScoreFile);
+        context.startTiming();
+        for (qint64 i = 0; i < context.iterations(); ++i) {
+            manager.addHighScore("Bench", static_cast<int>(i % 10000));
+        }
+        context.stopTiming();
+    });
+    
+    // One scene is shared by the render benchmarks; it is left to play for a
+    // moment after each resize so there are balls, particles and a built
+    // brick layer to draw. No events are processed while timing, so every
+    // iteration paints the same frame.
+    LevelManager levels;
+    levels.loadLevels();
+    GameScene scene;
+    scene.applySoundSettings(false, false, 0.0f, 0.0f);
+    scene.setLevelManager(&levels);
+    scene.loadCurrentLevel();
+    
+    for (QSize size : { QSize(800, 600), QSize(1280, 960), QSize(1920, 1440), QSize(3840, 2880) }) {
+        runner.add(QString("render/paint/%1x%2").arg(size.width()).arg(size.height()),
+                   [&scene, size](BenchmarkContext &context) {
+            if (scene.size() != size) {
+                scene.resize(size);
+                settle(300);
+            }
+            QImage image(size, QImage::Format_ARGB32_Premultiplied);
+            context.startTiming();
+            for (qint64 i = 0; i < context.iterations(); ++i) {
+                scene.render(&image);
+            }
+            context.stopTiming();
+        });
+    }
+    
+    // Encoder cost per captured frame; runs on FrameCapture's pool, so this
+    // bounds the capture rate per encoder thread
+    for (FrameCapture::Format format : { FrameCapture::Format::Png, FrameCapture::Format::Qoi }) {
+        runner.add(QString("capture/encode/%1/800x600").arg(format == FrameCapture::Format::Png ? "png" : "qoi"),
+                   [&scene, format](BenchmarkContext &context) {
+            if (scene.size() != QSize(800, 600)) {
+                scene.resize(800, 600);
+                settle(300);
+            }
+            QImage frame(scene.size(), QImage::Format_RGB32);
+            scene.render(&frame);
+            context.startTiming();
+            for (qint64 i = 0; i < context.iterations(); ++i) {
+                const QByteArray data = format == FrameCapture::Format::Png ? FrameCapture::encodePng(frame)
+                                                                             : FrameCapture::encodeQoi(frame);
+                Q_UNUSED(data);
+            }
+            context.stopTiming();
+        });
+    }
+    
+    if (parser.isSet(listOption)) {
+        QTextStream(stdout) << runner.names().join('\n') << '\n';
+        return 0;
+    }
+    
+    const std::vector<BenchmarkResult> results = runner.run(parser.value(filterOption));
+    const QByteArray json = BenchmarkRunner::toJson(results);
+    if (parser.isSet(outputOption)) {
+        QFile output(parser.value(outputOption));
+        if (!output.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "Could not write %s\n", qPrintable(output.fileName()));
+            return 1;
+        }
+        output.write(json);
+    } else {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+    }
+    
+    // The stress case has to keep up with a 60 Hz display; one frame is
+    // DEFAULT_TICK_RATE / 60 steps of the world
+    const double budgetMs = parser.value(frameBudgetOption).toDouble();
+    for (const BenchmarkResult &result : results) {
+        if (budgetMs <= 0.0 || result.name != FRAME_BUDGET_BENCHMARK) {
+            continue;
+        }
+        const double frameMs = result.meanNs * GameWorld::DEFAULT_TICK_RATE / 60.0 / 1e6;
+        if (frameMs > budgetMs) {
+            std::fprintf(stderr, "%s: %.2f ms per 60 Hz frame, over the %.1f ms budget\n",
+                         qPrintable(result.name), frameMs, budgetMs);
+            return 1;
+        }
+    }
+    if (countShort) {
+        std::fprintf(stderr, "collision: a step ran with fewer balls than its case names, or after the level ended\n");
+        return 1;
+    }
+    if (poolGrew) {
+        std::fprintf(stderr, "%s: the power-up pool outgrew its initial slots\n", POWER_UP_SOAK_BENCHMARK);
+        return 1;
+    }
+    if (replayDiverged) {
+        std::fprintf(stderr, "%s: playback did not end in the recorded state\n", REPLAY_BENCHMARK);
+        return 1;
+    }
+    return 0;
+}
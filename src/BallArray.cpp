@@ -0,0 +1,172 @@
+#include "BallArray.h"
+#include <algorithm>
+#include <cmath>
+
+BallArray::BallArray()
+{
+}
+
+void BallArray::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_vx.clear();
+    m_vy.clear();
+    m_radius.clear();
+}
+
+void BallArray::reserve(int count)
+{
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_vx.reserve(count);
+    m_vy.reserve(count);
+    m_radius.reserve(count);
+}
+
+int BallArray::add(qreal x, qreal y, qreal vx, qreal vy, qreal radius)
+{
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_vx.push_back(vx);
+    m_vy.push_back(vy);
+    m_radius.push_back(radius);
+    return size() - 1;
+}
+
+void BallArray::remove(int index)
+{
+    const int last = size() - 1;
+    m_x[index] = m_x[last];
+    m_y[index] = m_y[last];
+    m_vx[index] = m_vx[last];
+    m_vy[index] = m_vy[last];
+    m_radius[index] = m_radius[last];
+    
+    m_x.pop_back();
+    m_y.pop_back();
+    m_vx.pop_back();
+    m_vy.pop_back();
+    m_radius.pop_back();
+}
+
+qreal BallArray::speed(int index) const
+{
+    return std::sqrt(m_vx[index] * m_vx[index] + m_vy[index] * m_vy[index]);
+}
+
+void BallArray::setPosition(int index, qreal x, qreal y)
+{
+    m_x[index] = x;
+    m_y[index] = y;
+}
+
+void BallArray::setVelocity(int index, qreal vx, qreal vy)
+{
+    m_vx[index] = vx;
+    m_vy[index] = vy;
+}
+
+void BallArray::setSpeed(int index, qreal speed)
+{
+    // Maintain current direction but change magnitude
+    qreal currentSpeed = this->speed(index);
+    
+    if (currentSpeed > 0.0) {
+        qreal scale = speed / currentSpeed;
+        m_vx[index] *= scale;
+        m_vy[index] *= scale;
+    } else {
+        // Default direction if velocity is zero
+        m_vx[index] = speed * 0.707;
+        m_vy[index] = -speed * 0.707;
+    }
+}
+
+void BallArray::moveOne(int index, qreal delta)
+{
+    m_x[index] += m_vx[index] * delta;
+    m_y[index] += m_vy[index] * delta;
+}
+
+void BallArray::move(qreal delta, const std::vector<quint8> &skip)
+{
+    const int count = size();
+    qreal *x = m_x.data();
+    qreal *y = m_y.data();
+    const qreal *vx = m_vx.data();
+    const qreal *vy = m_vy.data();
+    const quint8 *skipped = skip.data();
+    
+    for (int i = 0; i < count; ++i) {
+        const qreal step = skipped[i] ? 0.0 : delta;
+        x[i] += vx[i] * step;
+        y[i] += vy[i] * step;
+    }
+}
+
+void BallArray::checkBoundaryCollision(qreal minX, qreal maxX, qreal minY)
+{
+    const int count = size();
+    qreal *x = m_x.data();
+    qreal *y = m_y.data();
+    qreal *vx = m_vx.data();
+    qreal *vy = m_vy.data();
+    const qreal *radius = m_radius.data();
+    
+    // Point velocities back into the field rather than flipping them, so a
+    // ball resting on a wall can't oscillate
+    for (int i = 0; i < count; ++i) {
+        const qreal left = minX + radius[i];
+        const qreal right = maxX - radius[i];
+        const qreal top = minY + radius[i];
+        const qreal speedX = std::abs(vx[i]);
+        const qreal speedY = std::abs(vy[i]);
+        
+        vx[i] = x[i] <= left ? speedX : (x[i] >= right ? -speedX : vx[i]);
+        vy[i] = y[i] <= top ? speedY : vy[i];
+        x[i] = std::min(std::max(x[i], left), right);
+        y[i] = std::max(y[i], top);
+    }
+}
+
+void BallArray::markPathsTouching(const QRectF &area, qreal delta, std::vector<quint8> &marks) const
+{
+    if (area.isEmpty()) {
+        return;
+    }
+    
+    const int count = size();
+    const qreal *x = m_x.data();
+    const qreal *y = m_y.data();
+    const qreal *vx = m_vx.data();
+    const qreal *vy = m_vy.data();
+    const qreal *radius = m_radius.data();
+    quint8 *marked = marks.data();
+    const qreal left = area.left();
+    const qreal right = area.right();
+    const qreal top = area.top();
+    const qreal bottom = area.bottom();
+    
+    for (int i = 0; i < count; ++i) {
+        const qreal endX = x[i] + vx[i] * delta;
+        const qreal endY = y[i] + vy[i] * delta;
+        const bool touches = std::min(x[i], endX) - radius[i] <= right &&
+                             std::max(x[i], endX) + radius[i] >= left &&
+                             std::min(y[i], endY) - radius[i] <= bottom &&
+                             std::max(y[i], endY) + radius[i] >= top;
+        marked[i] |= touches ? 1 : 0;
+    }
+}
+
+void BallArray::scaleVelocities(qreal factor)
+{
+    const int count = size();
+    qreal *vx = m_vx.data();
+    qreal *vy = m_vy.data();
+    
+    for (int i = 0; i < count; ++i) {
+        vx[i] *= factor;
+        vy[i] *= factor;
+    }
+}
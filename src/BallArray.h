@@ -0,0 +1,52 @@
+#ifndef BALLARRAY_H
+#define BALLARRAY_H
+
+#include <QPointF>
+#include <QRectF>
+#include <vector>
+
+// All balls in play, packed as parallel arrays. The bulk operations are
+// written as straight loops over contiguous data without branches so the
+// compiler can vectorise them across balls.
+class BallArray
+{
+public:
+    BallArray();
+    
+    void clear();
+    void reserve(int count);
+    int add(qreal x, qreal y, qreal vx, qreal vy, qreal radius);
+    void remove(int index);  // Swap-removes, so the last ball takes index's place
+    
+    int size() const { return static_cast<int>(m_x.size()); }
+    bool isEmpty() const { return m_x.empty(); }
+    
+    QPointF position(int index) const { return QPointF(m_x[index], m_y[index]); }
+    QPointF velocity(int index) const { return QPointF(m_vx[index], m_vy[index]); }
+    qreal x(int index) const { return m_x[index]; }
+    qreal y(int index) const { return m_y[index]; }
+    qreal radius(int index) const { return m_radius[index]; }
+    qreal speed(int index) const;
+    
+    void setPosition(int index, qreal x, qreal y);
+    void setVelocity(int index, qreal vx, qreal vy);
+    void setSpeed(int index, qreal speed);
+    void moveOne(int index, qreal delta);
+    
+    // Batch operations over every ball; move() leaves ball i in place when skip[i] != 0
+    void move(qreal delta, const std::vector<quint8> &skip);
+    void checkBoundaryCollision(qreal minX, qreal maxX, qreal minY);
+    void scaleVelocities(qreal factor);
+    
+    // Sets marks[i] to 1 for every ball whose path over delta may reach area
+    void markPathsTouching(const QRectF &area, qreal delta, std::vector<quint8> &marks) const;
+
+private:
+    std::vector<qreal> m_x;
+    std::vector<qreal> m_y;
+    std::vector<qreal> m_vx;
+    std::vector<qreal> m_vy;
+    std::vector<qreal> m_radius;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "BallTrail.h"
+#include <algorithm>
+
+BallTrail::BallTrail(int length)
+    : m_head(0), m_count(0)
+{
+    setLength(length);
+}
+
+void BallTrail::setLength(int length)
+{
+    // Resizing reorders the ring, so just start a fresh trail
+    m_points.assign(std::max(0, length), QPointF());
+    clear();
+}
+
+void BallTrail::clear()
+{
+    m_head = 0;
+    m_count = 0;
+}
+
+void BallTrail::push(const QPointF &point)
+{
+    const int length = this->length();
+    if (length == 0) {
+        return;
+    }
+    
+    m_points[m_head] = point;
+    m_head = (m_head + 1) % length;
+    m_count = std::min(m_count + 1, length);
+}
+
+const QPointF &BallTrail::at(int index) const
+{
+    const int length = this->length();
+    return m_points[(m_head - m_count + index + length) % length];
+}
@@ -0,0 +1,33 @@
+#ifndef BALLTRAIL_H
+#define BALLTRAIL_H
+
+#include <QPointF>
+#include <vector>
+
+// Fixed-length ring buffer of recent ball positions. Pushing past the
+// length overwrites the oldest point, so recording never allocates.
+class BallTrail
+{
+public:
+    explicit BallTrail(int length = DEFAULT_LENGTH);
+    
+    void setLength(int length);
+    int length() const { return static_cast<int>(m_points.size()); }
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    void clear();
+    
+    void push(const QPointF &point);
+    
+    // Index 0 is the oldest point, size() - 1 the newest
+    const QPointF &at(int index) const;
+    
+    static constexpr int DEFAULT_LENGTH = 10;
+
+private:
+    std::vector<QPointF> m_points;
+    int m_head;   // Slot the next point is written to
+    int m_count;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "BrickField.h"
+#include <algorithm>
+
+BrickField::BrickField()
+    : m_activeCount(0)
+{
+}
+
+void BrickField::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_width.clear();
+    m_height.clear();
+    m_hitPoints.clear();
+    m_maxHitPoints.clear();
+    m_colorIndex.clear();
+    m_active.clear();
+    m_palette.clear();
+    m_activeCount = 0;
+}
+
+void BrickField::reserve(int count)
+{
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_width.reserve(count);
+    m_height.reserve(count);
+    m_hitPoints.reserve(count);
+    m_maxHitPoints.reserve(count);
+    m_colorIndex.reserve(count);
+    m_active.reserve((count + 63) / 64);
+}
+
+int BrickField::add(qreal x, qreal y, qreal width, qreal height, const QColor &color, int hitPoints)
+{
+    const int index = size();
+    const qint16 hp = static_cast<qint16>(std::clamp(hitPoints, 1, 0x7fff));
+    
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_width.push_back(width);
+    m_height.push_back(height);
+    m_hitPoints.push_back(hp);
+    m_maxHitPoints.push_back(hp);
+    m_colorIndex.push_back(paletteIndex(color));
+    
+    if ((index & 63) == 0) {
+        m_active.push_back(0);
+    }
+    m_active[index >> 6] |= quint64(1) << (index & 63);
+    m_activeCount++;
+    
+    return index;
+}
+
+quint16 BrickField::paletteIndex(const QColor &color)
+{
+    // Levels use a handful of colours, so a linear lookup is fine here
+    for (size_t i = 0; i < m_palette.size(); ++i) {
+        if (m_palette[i] == color) {
+            return static_cast<quint16>(i);
+        }
+    }
+    m_palette.push_back(color);
+    return static_cast<quint16>(m_palette.size() - 1);
+}
+
+bool BrickField::hit(int index)
+{
+    if (!isActive(index)) return false;
+    
+    m_hitPoints[index]--;
+    if (m_hitPoints[index] <= 0) {
+        m_active[index >> 6] &= ~(quint64(1) << (index & 63));
+        m_activeCount--;
+        return true;  // Brick destroyed
+    }
+    return false;  // Brick damaged but still active
+}
+
+QColor BrickField::currentColor(int index) const
+{
+    const QColor &base = m_palette[m_colorIndex[index]];
+    if (m_hitPoints[index] <= 0 || !isActive(index)) {
+        return base;
+    }
+    
+    // Darken color based on damage
+    qreal ratio = static_cast<qreal>(m_hitPoints[index]) / m_maxHitPoints[index];
+    int r = static_cast<int>(base.red() * ratio);
+    int g = static_cast<int>(base.green() * ratio);
+    int b = static_cast<int>(base.blue() * ratio);
+    
+    return QColor(r, g, b);
+}
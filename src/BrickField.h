@@ -0,0 +1,62 @@
+#ifndef BRICKFIELD_H
+#define BRICKFIELD_H
+
+#include <QRectF>
+#include <QColor>
+#include <QtAlgorithms>
+#include <vector>
+
+// All bricks of a level in structure-of-arrays form. Geometry, hit points and
+// palette indices live in parallel arrays; liveness is a bitset plus a running
+// count, so "any bricks left?" is O(1) and scans skip dead bricks 64 at a time.
+class BrickField
+{
+public:
+    BrickField();
+    
+    void clear();
+    void reserve(int count);
+    int add(qreal x, qreal y, qreal width, qreal height, const QColor &color, int hitPoints = 1);
+    
+    int size() const { return static_cast<int>(m_x.size()); }
+    int activeCount() const { return m_activeCount; }
+    bool allDestroyed() const { return m_activeCount == 0; }
+    
+    bool isActive(int index) const { return (m_active[index >> 6] >> (index & 63)) & 1; }
+    bool hit(int index);  // Returns true if brick is destroyed
+    
+    QRectF rect(int index) const { return QRectF(m_x[index], m_y[index], m_width[index], m_height[index]); }
+    QColor color(int index) const { return m_palette[m_colorIndex[index]]; }
+    QColor currentColor(int index) const;  // Returns color based on hit points
+    int hitPoints(int index) const { return m_hitPoints[index]; }
+    int maxHitPoints(int index) const { return m_maxHitPoints[index]; }
+    
+    // Calls fn(index) for every active brick in index order
+    template <typename Fn>
+    void forEachActive(Fn fn) const
+    {
+        for (size_t word = 0; word < m_active.size(); ++word) {
+            quint64 bits = m_active[word];
+            while (bits) {
+                fn(static_cast<int>(word * 64 + qCountTrailingZeroBits(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+private:
+    quint16 paletteIndex(const QColor &color);
+    
+    std::vector<qreal> m_x;
+    std::vector<qreal> m_y;
+    std::vector<qreal> m_width;
+    std::vector<qreal> m_height;
+    std::vector<qint16> m_hitPoints;
+    std::vector<qint16> m_maxHitPoints;
+    std::vector<quint16> m_colorIndex;
+    std::vector<quint64> m_active;
+    std::vector<QColor> m_palette;
+    int m_activeCount;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "BrickGrid.h"
+#include <algorithm>
+#include <cmath>
+
+BrickGrid::BrickGrid()
+    : m_originX(0.0), m_originY(0.0), m_cellWidth(1.0), m_cellHeight(1.0),
+      m_columns(0), m_rows(0)
+{
+}
+
+void BrickGrid::clear()
+{
+    m_columns = 0;
+    m_rows = 0;
+    m_cellStart.clear();
+    m_cellBricks.clear();
+}
+
+void BrickGrid::build(const std::vector<QRectF> &brickRects, qreal cellWidth, qreal cellHeight)
+{
+    clear();
+    
+    if (brickRects.empty() || cellWidth <= 0.0 || cellHeight <= 0.0) {
+        return;
+    }
+    
+    qreal left = brickRects.front().left();
+    qreal top = brickRects.front().top();
+    qreal right = brickRects.front().right();
+    qreal bottom = brickRects.front().bottom();
+    for (const QRectF &rect : brickRects) {
+        left = std::min(left, rect.left());
+        top = std::min(top, rect.top());
+        right = std::max(right, rect.right());
+        bottom = std::max(bottom, rect.bottom());
+    }
+    
+    m_originX = left;
+    m_originY = top;
+    m_cellWidth = cellWidth;
+    m_cellHeight = cellHeight;
+    m_columns = static_cast<int>(std::floor((right - left) / cellWidth)) + 1;
+    m_rows = static_cast<int>(std::floor((bottom - top) / cellHeight)) + 1;
+    
+    // Counting pass, then prefix sums, then fill (compressed row storage)
+    m_cellStart.assign(m_columns * m_rows + 1, 0);
+    for (const QRectF &rect : brickRects) {
+        for (int row = rowAt(rect.top()); row <= rowAt(rect.bottom()); ++row) {
+            for (int col = columnAt(rect.left()); col <= columnAt(rect.right()); ++col) {
+                m_cellStart[cellIndex(col, row) + 1]++;
+            }
+        }
+    }
+    
+    for (size_t i = 1; i < m_cellStart.size(); ++i) {
+        m_cellStart[i] += m_cellStart[i - 1];
+    }
+    
+    m_cellBricks.resize(m_cellStart.back());
+    std::vector<int> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t i = 0; i < brickRects.size(); ++i) {
+        const QRectF &rect = brickRects[i];
+        for (int row = rowAt(rect.top()); row <= rowAt(rect.bottom()); ++row) {
+            for (int col = columnAt(rect.left()); col <= columnAt(rect.right()); ++col) {
+                m_cellBricks[fill[cellIndex(col, row)]++] = static_cast<int>(i);
+            }
+        }
+    }
+}
+
+void BrickGrid::query(const QRectF &area, std::vector<int> &out) const
+{
+    if (m_columns == 0) {
+        return;
+    }
+    
+    const qreal gridRight = m_originX + m_columns * m_cellWidth;
+    const qreal gridBottom = m_originY + m_rows * m_cellHeight;
+    if (area.right() < m_originX || area.left() > gridRight ||
+        area.bottom() < m_originY || area.top() > gridBottom) {
+        return;
+    }
+    
+    const int firstCol = columnAt(area.left());
+    const int lastCol = columnAt(area.right());
+    const int firstRow = rowAt(area.top());
+    const int lastRow = rowAt(area.bottom());
+    
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            const int cell = cellIndex(col, row);
+            out.insert(out.end(), m_cellBricks.begin() + m_cellStart[cell],
+                       m_cellBricks.begin() + m_cellStart[cell + 1]);
+        }
+    }
+}
+
+QRectF BrickGrid::bounds() const
+{
+    if (m_columns == 0) {
+        return QRectF();
+    }
+    return QRectF(m_originX, m_originY, m_columns * m_cellWidth, m_rows * m_cellHeight);
+}
+
+int BrickGrid::columnAt(qreal x) const
+{
+    int col = static_cast<int>(std::floor((x - m_originX) / m_cellWidth));
+    return std::clamp(col, 0, m_columns - 1);
+}
+
+int BrickGrid::rowAt(qreal y) const
+{
+    int row = static_cast<int>(std::floor((y - m_originY) / m_cellHeight));
+    return std::clamp(row, 0, m_rows - 1);
+}
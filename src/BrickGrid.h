@@ -0,0 +1,41 @@
+#ifndef BRICKGRID_H
+#define BRICKGRID_H
+
+#include <QRectF>
+#include <vector>
+
+// Uniform grid over the brick layout. Cells match the brick lattice pitch, so
+// a ball-sized query touches at most a 2x2 block of cells no matter how many
+// bricks the level has. Bricks are referred to by their index in the world.
+class BrickGrid
+{
+public:
+    BrickGrid();
+    
+    void build(const std::vector<QRectF> &brickRects, qreal cellWidth, qreal cellHeight);
+    void clear();
+    
+    // Appends the indices of bricks sharing a cell with area (may repeat an
+    // index if a brick spans several of the visited cells)
+    void query(const QRectF &area, std::vector<int> &out) const;
+    
+    QRectF bounds() const;
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+
+private:
+    int cellIndex(int col, int row) const { return row * m_columns + col; }
+    int columnAt(qreal x) const;
+    int rowAt(qreal y) const;
+    
+    qreal m_originX;
+    qreal m_originY;
+    qreal m_cellWidth;
+    qreal m_cellHeight;
+    int m_columns;
+    int m_rows;
+    std::vector<int> m_cellStart;   // m_columns * m_rows + 1 offsets into m_cellBricks
+    std::vector<int> m_cellBricks;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "CachedText.h"
+#include <QFontMetricsF>
+
+CachedText::CachedText(const QFont &font, const QString &text)
+    : m_font(font), m_ascent(QFontMetricsF(font).ascent()), m_key(0), m_valid(false)
+{
+    m_text.setTextFormat(Qt::PlainText);
+    m_text.setPerformanceHint(QStaticText::AggressiveCaching);
+    setText(text);
+}
+
+void CachedText::setText(const QString &text)
+{
+    m_text.setText(text);
+    m_text.prepare(QTransform(), m_font);
+}
+
+void CachedText::draw(QPainter &painter, qreal x, qreal baselineY) const
+{
+    painter.setFont(m_font);
+    painter.drawStaticText(QPointF(x, baselineY - m_ascent), m_text);
+}
+
+void CachedText::drawCentered(QPainter &painter, const QRectF &rect) const
+{
+    const QSizeF size = m_text.size();
+    painter.setFont(m_font);
+    painter.drawStaticText(QPointF(rect.center().x() - size.width() / 2.0,
+                                   rect.center().y() - size.height() / 2.0), m_text);
+}
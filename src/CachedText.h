@@ -0,0 +1,43 @@
+#ifndef CACHEDTEXT_H
+#define CACHEDTEXT_H
+
+#include <QFont>
+#include <QStaticText>
+#include <QPainter>
+
+// A laid-out string that is only rebuilt when its key changes. HUD values
+// are passed as the key, so formatting and text layout happen once per new
+// value instead of once per frame.
+class CachedText
+{
+public:
+    explicit CachedText(const QFont &font = QFont(), const QString &text = QString());
+    
+    // Calls makeText() only if key differs from the previous call
+    template <typename Fn>
+    void update(qint64 key, Fn makeText)
+    {
+        if (!m_valid || key != m_key) {
+            setText(makeText());
+            m_key = key;
+            m_valid = true;
+        }
+    }
+    
+    void setText(const QString &text);
+    const QFont &font() const { return m_font; }
+    
+    // Same anchoring as QPainter::drawText(point, ...): x, y is the baseline start
+    void draw(QPainter &painter, qreal x, qreal baselineY) const;
+    // Centers the text in rect like Qt::AlignCenter
+    void drawCentered(QPainter &painter, const QRectF &rect) const;
+
+private:
+    QFont m_font;
+    QStaticText m_text;
+    qreal m_ascent;
+    qint64 m_key;
+    bool m_valid;
+};
+
+#endif
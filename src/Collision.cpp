@@ -0,0 +1,121 @@
+#include "Collision.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+qreal dot(const QPointF &a, const QPointF &b)
+{
+    return a.x() * b.x() + a.y() * b.y();
+}
+
+// Entry/exit times of a 1D ray against the slab [lo, hi]
+bool slab(qreal origin, qreal motion, qreal lo, qreal hi, qreal &enter, qreal &exit)
+{
+    if (motion == 0.0) {
+        if (origin < lo || origin > hi) {
+            return false;
+        }
+        enter = -std::numeric_limits<qreal>::infinity();
+        exit = std::numeric_limits<qreal>::infinity();
+        return true;
+    }
+    
+    qreal t1 = (lo - origin) / motion;
+    qreal t2 = (hi - origin) / motion;
+    enter = std::min(t1, t2);
+    exit = std::max(t1, t2);
+    return true;
+}
+
+}
+
+bool sweepCircleRect(const QPointF &center, const QPointF &motion, qreal radius,
+                     const QRectF &rect, SweepHit &hit)
+{
+    // Already overlapping: report an immediate contact pushing out of the rect
+    QPointF closest(qBound(rect.left(), center.x(), rect.right()),
+                    qBound(rect.top(), center.y(), rect.bottom()));
+    QPointF offset = center - closest;
+    qreal distSq = dot(offset, offset);
+    
+    if (distSq < radius * radius) {
+        QPointF normal;
+        if (distSq > 0.0) {
+            normal = offset * (1.0 / std::sqrt(distSq));
+        } else {
+            // Centre inside the rect: leave through the nearest edge
+            qreal left = center.x() - rect.left();
+            qreal right = rect.right() - center.x();
+            qreal top = center.y() - rect.top();
+            qreal bottom = rect.bottom() - center.y();
+            qreal nearest = std::min({left, right, top, bottom});
+            if (nearest == top) normal = QPointF(0.0, -1.0);
+            else if (nearest == bottom) normal = QPointF(0.0, 1.0);
+            else if (nearest == left) normal = QPointF(-1.0, 0.0);
+            else normal = QPointF(1.0, 0.0);
+        }
+        
+        if (dot(motion, normal) >= 0.0) {
+            return false;
+        }
+        hit.time = 0.0;
+        hit.normal = normal;
+        return true;
+    }
+    
+    // Ray against the rect grown by the radius
+    qreal enterX, exitX, enterY, exitY;
+    if (!slab(center.x(), motion.x(), rect.left() - radius, rect.right() + radius, enterX, exitX) ||
+        !slab(center.y(), motion.y(), rect.top() - radius, rect.bottom() + radius, enterY, exitY)) {
+        return false;
+    }
+    
+    qreal enter = std::max(enterX, enterY);
+    qreal exit = std::min(exitX, exitY);
+    if (enter > exit || enter > 1.0 || exit < 0.0) {
+        return false;
+    }
+    
+    qreal t = std::max(enter, 0.0);
+    QPointF contact = center + motion * t;
+    
+    bool outsideX = contact.x() < rect.left() || contact.x() > rect.right();
+    bool outsideY = contact.y() < rect.top() || contact.y() > rect.bottom();
+    
+    QPointF normal;
+    if (outsideX && outsideY) {
+        // Corner region of the grown rect: intersect with the rounded corner
+        QPointF corner(contact.x() < rect.left() ? rect.left() : rect.right(),
+                       contact.y() < rect.top() ? rect.top() : rect.bottom());
+        QPointF f = center - corner;
+        qreal a = dot(motion, motion);
+        qreal b = 2.0 * dot(f, motion);
+        qreal c = dot(f, f) - radius * radius;
+        qreal disc = b * b - 4.0 * a * c;
+        if (a == 0.0 || disc < 0.0) {
+            return false;
+        }
+        
+        t = (-b - std::sqrt(disc)) / (2.0 * a);
+        if (t < 0.0 || t > 1.0) {
+            return false;
+        }
+        normal = (center + motion * t - corner) * (1.0 / radius);
+    } else if (outsideX) {
+        normal = QPointF(contact.x() < rect.left() ? -1.0 : 1.0, 0.0);
+    } else if (outsideY) {
+        normal = QPointF(0.0, contact.y() < rect.top() ? -1.0 : 1.0);
+    } else {
+        return false;
+    }
+    
+    if (dot(motion, normal) >= 0.0) {
+        return false;
+    }
+    
+    hit.time = t;
+    hit.normal = normal;
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <QPointF>
+#include <QRectF>
+
+struct SweepHit
+{
+    qreal time = 1.0;   // Fraction of the motion at first contact, in [0, 1]
+    QPointF normal;     // Contact normal pointing away from the rect
+};
+
+// Swept circle vs axis-aligned rect. Finds the earliest time the circle at
+// center moving by motion touches rect. Contacts the circle is already moving
+// away from are ignored, so a resolved contact is not reported again.
+bool sweepCircleRect(const QPointF &center, const QPointF &motion, qreal radius,
+                     const QRectF &rect, SweepHit &hit);
+
+#endif
@@ -0,0 +1,301 @@
+#include "FrameCapture.h"
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImageWriter>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// Qt maps a PNG quality of 80 to a low zlib level: captures favour encode
+// speed over file size
+constexpr int PNG_QUALITY = 80;
+
+QString fileName(int index, FrameCapture::Format format)
+{
+    return QString("frame_%1.%2").arg(index, 6, 10, QChar('0'))
+                                  .arg(format == FrameCapture::Format::Png ? "png" : "qoi");
+}
+
+void appendBigEndian(QByteArray &out, quint32 value)
+{
+    out.append(static_cast<char>(value >> 24));
+    out.append(static_cast<char>(value >> 16));
+    out.append(static_cast<char>(value >> 8));
+    out.append(static_cast<char>(value));
+}
+
+} // namespace
+
+FrameCapture::FrameCapture()
+    : m_format(Format::Png), m_active(false), m_frameLimit(0), m_maxPending(0), m_submitted(0), m_dropped(0),
+      m_firstTimestamp(0), m_pending(0)
+{
+    // The GUI and simulation threads keep a core each
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 2));
+    m_maxPending = m_pool.maxThreadCount() * 2;
+}
+
+FrameCapture::~FrameCapture()
+{
+    stop();
+}
+
+bool FrameCapture::start(const QString &directory, Format format)
+{
+    stop();
+    
+    if (!QDir().mkpath(directory)) {
+        qWarning() << "Could not create capture directory" << directory;
+        return false;
+    }
+    
+    m_directory = directory;
+    m_format = format;
+    m_submitted = 0;
+    m_dropped = 0;
+    m_firstTimestamp = 0;
+    m_records.clear();
+    m_active = true;
+    qDebug() << "Capturing frames to" << directory;
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+    m_pool.waitForDone();
+    
+    writeIndex();
+    qDebug() << "Captured" << m_submitted << "frames to" << m_directory << "with" << m_dropped << "dropped";
+}
+
+bool FrameCapture::canAccept() const
+{
+    return m_active && !isFull() && m_pending.load(std::memory_order_acquire) < m_maxPending;
+}
+
+bool FrameCapture::submit(const QImage &image, quint64 tick, qint64 timestamp)
+{
+    if (!m_active || isFull()) {
+        return false;
+    }
+    if (m_pending.load(std::memory_order_acquire) >= m_maxPending) {
+        ++m_dropped;
+        return false;
+    }
+    
+    if (m_submitted == 0) {
+        m_firstTimestamp = timestamp;
+    }
+    FrameRecord record;
+    record.index = m_submitted++;
+    record.tick = tick;
+    record.timestamp = timestamp - m_firstTimestamp;
+    
+    // The image is implicitly shared; the GUI thread only paints into it
+    // again once the encoder has released it
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    m_pool.start([this, image, record] { encode(image, record); });
+    return true;
+}
+
+void FrameCapture::encode(const QImage &image, FrameRecord record)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const QString path = QDir(m_directory).filePath(fileName(record.index, m_format));
+    
+    QByteArray data;
+    if (m_format == Format::Png) {
+        QMap<QString, QString> text;
+        text["Frame"] = QString::number(record.index);
+        text["Tick"] = QString::number(record.tick);
+        text["Timestamp"] = QString::number(record.timestamp);
+        data = encodePng(image, text);
+    } else {
+        data = encodeQoi(image);
+    }
+    
+    QFile file(path);
+    if (!data.isEmpty() && file.open(QIODevice::WriteOnly) && file.write(data) == data.size()) {
+        record.bytes = data.size();
+    } else {
+        qWarning() << "Could not write frame" << path;
+    }
+    
+    record.encodeTime = timer.nsecsElapsed();
+    {
+        QMutexLocker lock(&m_mutex);
+        m_records.push_back(record);
+    }
+    m_pending.fetch_sub(1, std::memory_order_release);
+}
+
+bool FrameCapture::writeIndex() const
+{
+    std::vector<FrameRecord> records;
+    {
+        QMutexLocker lock(&m_mutex);
+        records = m_records;
+    }
+    std::sort(records.begin(), records.end(), [](const FrameRecord &a, const FrameRecord &b) {
+        return a.index < b.index;
+    });
+    
+    // Timestamps are in milliseconds from the first frame
+    QJsonArray frames;
+    for (const FrameRecord &record : records) {
+        QJsonObject frame;
+        frame["index"] = record.index;
+        frame["file"] = fileName(record.index, m_format);
+        frame["tick"] = static_cast<qint64>(record.tick);
+        frame["timestamp"] = record.timestamp / 1e6;
+        frame["encodeMs"] = record.encodeTime / 1e6;
+        frame["bytes"] = record.bytes;
+        frames.append(frame);
+    }
+    
+    QJsonObject root;
+    root["format"] = m_format == Format::Png ? "png" : "qoi";
+    root["frameCount"] = m_submitted;
+    root["dropped"] = m_dropped;
+    root["frames"] = frames;
+    
+    const QString path = QDir(m_directory).filePath(INDEX_FILE_NAME);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write capture index" << path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+FrameCapture::Format FrameCapture::formatFromName(const QString &name, bool *ok)
+{
+    const QString lower = name.toLower();
+    if (ok) {
+        *ok = lower == "png" || lower == "qoi";
+    }
+    return lower == "qoi" ? Format::Qoi : Format::Png;
+}
+
+QByteArray FrameCapture::encodePng(const QImage &image, const QMap<QString, QString> &text)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "png");
+    writer.setQuality(PNG_QUALITY);
+    for (auto it = text.cbegin(); it != text.cend(); ++it) {
+        writer.setText(it.key(), it.value());
+    }
+    if (!writer.write(image)) {
+        qWarning() << "Could not encode PNG:" << writer.errorString();
+        return QByteArray();
+    }
+    return data;
+}
+
+QByteArray FrameCapture::encodeQoi(const QImage &image)
+{
+    // Straight from the QOI specification: each pixel becomes a run of the
+    // previous pixel, a slot in a 64-entry hash of recent pixels, a small
+    // difference from the previous pixel, or a literal
+    const bool alpha = image.hasAlphaChannel();
+    const int channels = alpha ? 4 : 3;
+    const QImage pixels = image.convertToFormat(alpha ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+    const int width = pixels.width();
+    const int height = pixels.height();
+    
+    QByteArray out;
+    out.reserve(14 + width * height * (channels + 1) + 8);
+    out.append("qoif", 4);
+    appendBigEndian(out, static_cast<quint32>(width));
+    appendBigEndian(out, static_cast<quint32>(height));
+    out.append(static_cast<char>(channels));
+    out.append(static_cast<char>(0));  // sRGB with linear alpha
+    
+    struct Rgba
+    {
+        quint8 r, g, b, a;
+        bool operator==(const Rgba &other) const
+        {
+            return r == other.r && g == other.g && b == other.b && a == other.a;
+        }
+    };
+    
+    Rgba seen[64] = {};
+    Rgba previous = { 0, 0, 0, 255 };
+    int run = 0;
+    
+    for (int y = 0; y < height; ++y) {
+        const uchar *line = pixels.constScanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const uchar *p = line + x * channels;
+            const Rgba pixel = { p[0], p[1], p[2], alpha ? p[3] : quint8(255) };
+            const bool last = y == height - 1 && x == width - 1;
+            
+            if (pixel == previous) {
+                ++run;
+                if (run == 62 || last) {
+                    out.append(static_cast<char>(0xc0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            
+            if (run > 0) {
+                out.append(static_cast<char>(0xc0 | (run - 1)));
+                run = 0;
+            }
+            
+            const int slot = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+            if (seen[slot] == pixel) {
+                out.append(static_cast<char>(slot));
+            } else {
+                seen[slot] = pixel;
+                if (pixel.a == previous.a) {
+                    const qint8 dr = static_cast<qint8>(pixel.r - previous.r);
+                    const qint8 dg = static_cast<qint8>(pixel.g - previous.g);
+                    const qint8 db = static_cast<qint8>(pixel.b - previous.b);
+                    const qint8 drg = static_cast<qint8>(dr - dg);
+                    const qint8 dbg = static_cast<qint8>(db - dg);
+                    
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        out.append(static_cast<char>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        out.append(static_cast<char>(0x80 | (dg + 32)));
+                        out.append(static_cast<char>((drg + 8) << 4 | (dbg + 8)));
+                    } else {
+                        out.append(static_cast<char>(0xfe));
+                        out.append(static_cast<char>(pixel.r));
+                        out.append(static_cast<char>(pixel.g));
+                        out.append(static_cast<char>(pixel.b));
+                    }
+                } else {
+                    out.append(static_cast<char>(0xff));
+                    out.append(static_cast<char>(pixel.r));
+                    out.append(static_cast<char>(pixel.g));
+                    out.append(static_cast<char>(pixel.b));
+                    out.append(static_cast<char>(pixel.a));
+                }
+            }
+            previous = pixel;
+        }
+    }
+    
+    out.append(QByteArray(7, '\0'));
+    out.append(static_cast<char>(1));
+    return out;
+}
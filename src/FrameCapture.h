@@ -0,0 +1,88 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <QString>
+#include <QImage>
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QThreadPool>
+#include <atomic>
+#include <vector>
+
+// Writes rendered frames to numbered image files on a pool of encoder
+// threads. The caller only hands over an implicitly shared QImage, so
+// submitting never waits on disk or compression; when the encoders fall
+// more than maxPending() frames behind, new frames are dropped instead.
+//
+// Files are frame_000000.png (or .qoi) in submission order, and stop()
+// writes frames.json next to them with the game tick, timestamp and encode
+// cost of every frame plus the number dropped.
+class FrameCapture
+{
+public:
+    enum class Format { Png, Qoi };
+    
+    FrameCapture();
+    ~FrameCapture();
+    
+    bool start(const QString &directory, Format format);
+    void stop();  // Waits for queued frames, then writes the index
+    bool isActive() const { return m_active; }
+    
+    // GUI thread. timestamp is in nanoseconds on any monotonic clock.
+    // Returns false if the frame was dropped.
+    bool submit(const QImage &image, quint64 tick, qint64 timestamp);
+    // GUI thread. Checked before rendering a frame, so a frame the encoders
+    // have no room for is never painted; the caller counts it with
+    // dropFrame() instead
+    bool canAccept() const;
+    void dropFrame() { ++m_dropped; }
+    
+    void setFrameLimit(int frames) { m_frameLimit = frames; }  // 0 = no limit
+    bool isFull() const { return m_frameLimit > 0 && m_submitted >= m_frameLimit; }
+    void setMaxPending(int frames) { m_maxPending = qMax(1, frames); }
+    int maxPending() const { return m_maxPending; }
+    
+    int framesSubmitted() const { return m_submitted; }
+    int framesDropped() const { return m_dropped; }
+    QString directory() const { return m_directory; }
+    
+    // text becomes PNG tEXt chunks
+    static QByteArray encodePng(const QImage &image, const QMap<QString, QString> &text = {});
+    // Quite OK Image format: lossless, and several times faster to encode
+    // than PNG
+    static QByteArray encodeQoi(const QImage &image);
+    static Format formatFromName(const QString &name, bool *ok = nullptr);
+    
+    static constexpr const char *INDEX_FILE_NAME = "frames.json";
+
+private:
+    struct FrameRecord
+    {
+        int index = 0;
+        quint64 tick = 0;
+        qint64 timestamp = 0;
+        qint64 encodeTime = 0;  // Nanoseconds, encode and write
+        qint64 bytes = 0;       // 0 if the write failed
+    };
+    
+    void encode(const QImage &image, FrameRecord record);
+    bool writeIndex() const;
+    
+    QThreadPool m_pool;
+    QString m_directory;
+    Format m_format;
+    bool m_active;
+    int m_frameLimit;
+    int m_maxPending;
+    int m_submitted;
+    int m_dropped;
+    qint64 m_firstTimestamp;
+    std::atomic<int> m_pending;
+    
+    mutable QMutex m_mutex;  // Guards m_records, which the encoders append to
+    std::vector<FrameRecord> m_records;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "FrameSnapshot.h"
+#include <algorithm>
+
+qreal FrameSnapshot::alphaAt(qint64 now) const
+{
+    qreal elapsed = accumulator;
+    if (running) {
+        elapsed += (now - publishedAt) / 1e9;
+    }
+    return std::min(std::max(elapsed / tickTime, 0.0), 1.0);
+}
+
+QRectF FrameSnapshot::paddleAt(qreal alpha) const
+{
+    QRectF rect = paddleRect;
+    rect.moveTopLeft(previousPaddleRect.topLeft() * (1.0 - alpha) + paddleRect.topLeft() * alpha);
+    return rect;
+}
+
+QPointF FrameSnapshot::ballAt(int index, qreal alpha) const
+{
+    if (previousBallPositions.size() != ballPositions.size()) {
+        return ballPositions[index];
+    }
+    return previousBallPositions[index] * (1.0 - alpha) + ballPositions[index] * alpha;
+}
+
+QRectF FrameSnapshot::powerUpAt(int index, qreal alpha) const
+{
+    const PowerUpSprite &powerUp = powerUps[index];
+    QRectF rect = powerUp.rect;
+    rect.moveTopLeft(powerUp.previousTopLeft * (1.0 - alpha) + powerUp.rect.topLeft() * alpha);
+    return rect;
+}
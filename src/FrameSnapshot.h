@@ -0,0 +1,63 @@
+#ifndef FRAMESNAPSHOT_H
+#define FRAMESNAPSHOT_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QColor>
+#include <vector>
+#include "GameWorld.h"
+#include "BrickField.h"
+#include "PowerUp.h"
+
+// Everything the scene needs to draw one frame, copied out of the world by
+// SimulationWorker. Positions from before the latest tick are kept next to
+// the current ones so the renderer can interpolate between them.
+struct FrameSnapshot
+{
+    struct PowerUpSprite
+    {
+        QRectF rect;
+        QPointF previousTopLeft;
+        PowerUpType type;
+        QColor color;
+    };
+    
+    struct ParticleSprite
+    {
+        QPointF position;
+        QRgb color;   // Includes the fade-out alpha
+        qreal size;
+    };
+    
+    quint64 tick = 0;
+    qint64 publishedAt = 0;   // SimulationWorker::now() at publish
+    qreal tickTime = 1.0 / GameWorld::DEFAULT_TICK_RATE;
+    qreal accumulator = 0.0;  // Time into the next tick at publish
+    bool running = false;     // Whether ticks are advancing at all
+    
+    WorldState state = WorldState::Playing;
+    int score = 0;
+    int lives = GameWorld::STARTING_LIVES;
+    bool invulnerable = false;
+    qreal invulnerabilityTimer = 0.0;
+    
+    QRectF paddleRect;
+    QRectF previousPaddleRect;
+    std::vector<QPointF> ballPositions;
+    std::vector<QPointF> previousBallPositions;  // Empty if the ball count changed
+    std::vector<qreal> ballRadii;
+    std::vector<PowerUpSprite> powerUps;         // Active power-ups only
+    
+    BrickField bricks;
+    quint32 brickLayoutId = 0;
+    
+    std::vector<ParticleSprite> particles;
+    
+    // Fraction of a tick elapsed since the latest tick, at time now
+    qreal alphaAt(qint64 now) const;
+    QRectF paddleAt(qreal alpha) const;
+    QPointF ballAt(int index, qreal alpha) const;
+    QRectF powerUpAt(int index, qreal alpha) const;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "HighScoreManager.h"
 #include "HighScoreDialog.h"
 #include "LevelManager.h"
+#include "Profiler.h"
 #include <QScreen>
 #include <QGuiApplication>
 #include <QMenuBar>
@@ -12,6 +13,8 @@
 #include <QApplication>
 #include <QMessageBox>
 #include <QInputDialog>
+#include <QFileDialog>
+#include <QSignalBlocker>
 #include <QIcon>
 
 Game::Game(QWidget *parent)
@@ -37,12 +40,19 @@ Game::Game(QWidget *parent)
     gameScene->setLevelManager(levelManager);
     gameScene->loadCurrentLevel();
     setCentralWidget(gameScene);
+    connect(gameScene, &GameScene::captureFinished, this, [this] {
+        captureAction->setChecked(false);
+        emit captureFinished();
+    });
     
     applySettings();
 }
 
 Game::~Game()
 {
+    // The scene may still be prefetching from the level manager, which as an
+    // earlier child would otherwise be destroyed first
+    delete gameScene;
 }
 
 void Game::setupWindow()
@@ -86,6 +96,29 @@ void Game::createActions()
     highScoresAction->setShortcut(tr("Ctrl+H"));
     connect(highScoresAction, &QAction::triggered, this, &Game::onHighScores);
 
+    saveReplayAction = new QAction(tr("Save &Replay..."), this);
+    connect(saveReplayAction, &QAction::triggered, this, &Game::onSaveReplay);
+    
+    playReplayAction = new QAction(tr("Play Repla&y..."), this);
+    connect(playReplayAction, &QAction::triggered, this, &Game::onPlayReplay);
+    
+    autopilotAction = new QAction(tr("&Autopilot"), this);
+    autopilotAction->setShortcut(tr("F4"));
+    autopilotAction->setCheckable(true);
+    connect(autopilotAction, &QAction::toggled, this, &Game::onToggleAutopilot);
+    
+    profilerAction = new QAction(tr("Show &Profiler"), this);
+    profilerAction->setShortcut(tr("F3"));
+    profilerAction->setCheckable(true);
+    connect(profilerAction, &QAction::toggled, this, &Game::onToggleProfiler);
+    
+    captureAction = new QAction(tr("&Capture Frames..."), this);
+    captureAction->setCheckable(true);
+    connect(captureAction, &QAction::toggled, this, &Game::onToggleCapture);
+    
+    exportTraceAction = new QAction(tr("Export Performance &Trace..."), this);
+    connect(exportTraceAction, &QAction::triggered, this, &Game::onExportTrace);
+    
     exitAction = new QAction(tr("E&xit"), this);
     exitAction->setShortcut(tr("Ctrl+Q"));
     connect(exitAction, &QAction::triggered, qApp, &QApplication::quit);
@@ -103,6 +136,14 @@ void Game::createMenus()
     gameMenu->addAction(highScoresAction);
     gameMenu->addAction(settingsAction);
     gameMenu->addSeparator();
+    gameMenu->addAction(saveReplayAction);
+    gameMenu->addAction(playReplayAction);
+    gameMenu->addAction(autopilotAction);
+    gameMenu->addSeparator();
+    gameMenu->addAction(profilerAction);
+    gameMenu->addAction(exportTraceAction);
+    gameMenu->addAction(captureAction);
+    gameMenu->addSeparator();
     gameMenu->addAction(exitAction);
 
     QMenu *helpMenu = menuBar()->addMenu(tr("&Help"));
@@ -133,6 +174,112 @@ void Game::onSettings()
     settingsDialog->exec();
 }
 
+void Game::onToggleAutopilot(bool enabled)
+{
+    if (gameScene) {
+        gameScene->setAutopilot(enabled);
+    }
+}
+
+void Game::onToggleCapture(bool enabled)
+{
+    if (!gameScene) {
+        return;
+    }
+    if (!enabled) {
+        gameScene->stopCapture();
+        return;
+    }
+    
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Capture Frames To"));
+    if (directory.isEmpty() || !gameScene->startCapture(directory, FrameCapture::Format::Png)) {
+        if (!directory.isEmpty()) {
+            QMessageBox::warning(this, tr("Capture Failed"),
+                                 tr("Could not capture frames to %1.").arg(directory));
+        }
+        QSignalBlocker blocker(captureAction);
+        captureAction->setChecked(false);
+    }
+}
+
+void Game::setAutopilot(bool enabled)
+{
+    autopilotAction->setChecked(enabled);
+}
+
+bool Game::playReplay(const QString &filePath)
+{
+    return gameScene->playReplay(filePath, 1);
+}
+
+bool Game::startCapture(const QString &directory, FrameCapture::Format format, int frameLimit)
+{
+    if (!gameScene->startCapture(directory, format, frameLimit)) {
+        return false;
+    }
+    QSignalBlocker blocker(captureAction);
+    captureAction->setChecked(true);
+    return true;
+}
+
+void Game::onToggleProfiler(bool visible)
+{
+    if (gameScene) {
+        gameScene->setProfilerVisible(visible);
+    }
+}
+
+void Game::onExportTrace()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export Performance Trace"),
+                                                    "arkanoid-trace.json",
+                                                    tr("Chrome Trace (*.json)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+    
+    if (!Profiler::instance().exportChromeTrace(filePath)) {
+        QMessageBox::warning(this, tr("Export Failed"),
+                             tr("Could not write the trace to %1.").arg(filePath));
+    }
+}
+
+void Game::onSaveReplay()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Save Replay"), "arkanoid.replay",
+                                                    tr("Replays (*.replay)"));
+    if (filePath.isEmpty() || !gameScene) {
+        return;
+    }
+    
+    if (!gameScene->saveReplay(filePath)) {
+        QMessageBox::warning(this, tr("Save Failed"),
+                             tr("Could not save the replay to %1.").arg(filePath));
+    }
+}
+
+void Game::onPlayReplay()
+{
+    QString filePath = QFileDialog::getOpenFileName(this, tr("Play Replay"), QString(),
+                                                    tr("Replays (*.replay)"));
+    if (filePath.isEmpty() || !gameScene) {
+        return;
+    }
+    
+    bool ok = false;
+    int speed = QInputDialog::getInt(this, tr("Play Replay"), tr("Playback speed (x):"),
+                                     1, 1, 64, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    if (!gameScene->playReplay(filePath, speed)) {
+        QMessageBox::warning(this, tr("Replay Failed"),
+                             tr("Could not play %1. The file may be damaged or need levels "
+                                "that are not installed.").arg(filePath));
+    }
+}
+
 void Game::onHighScores()
 {
     HighScoreDialog dialog(highScoreManager, this);
@@ -159,5 +306,8 @@ void Game::applySettings()
             settingsDialog->soundVolume() / 100.0f,
             settingsDialog->musicVolume() / 100.0f
         );
+        gameScene->setParticleBudget(settingsDialog->particleBudget());
+        gameScene->setTrailLength(settingsDialog->trailLength());
+        gameScene->setFrameRateCap(settingsDialog->frameRateCap(), settingsDialog->isVsyncEnabled());
     }
 }
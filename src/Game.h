@@ -2,6 +2,7 @@
 #define GAME_H
 
 #include <QMainWindow>
+#include "FrameCapture.h"
 
 class QAction;
 class GameScene;
@@ -16,6 +17,14 @@ class Game : public QMainWindow
 public:
     explicit Game(QWidget *parent = nullptr);
     ~Game();
+    
+    // Command-line entry points; see main.cpp
+    void setAutopilot(bool enabled);
+    bool playReplay(const QString &filePath);
+    bool startCapture(const QString &directory, FrameCapture::Format format, int frameLimit);
+
+signals:
+    void captureFinished();
 
 private:
     void setupWindow();
@@ -30,12 +39,24 @@ private slots:
     void onSettings();
     void onHighScores();
     void onSettingsChanged();
+    void onToggleAutopilot(bool enabled);
+    void onToggleCapture(bool enabled);
+    void onToggleProfiler(bool visible);
+    void onExportTrace();
+    void onSaveReplay();
+    void onPlayReplay();
 
 private:
     QAction *newGameAction;
     QAction *pauseAction;
     QAction *settingsAction;
     QAction *highScoresAction;
+    QAction *autopilotAction;
+    QAction *captureAction;
+    QAction *profilerAction;
+    QAction *exportTraceAction;
+    QAction *saveReplayAction;
+    QAction *playReplayAction;
     QAction *exitAction;
     QAction *aboutQtAction;
     GameScene *gameScene;
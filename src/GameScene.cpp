@@ -1,46 +1,105 @@
 #include "GameScene.h"
-#include "Paddle.h"
-#include "Ball.h"
-#include "Brick.h"
-#include "PowerUp.h"
 #include "SoundManager.h"
-#include "Particle.h"
+#include "Level.h"
+#include "Profiler.h"
 #include "HighScoreManager.h"
 #include "LevelManager.h"
 #include <QPainter>
 #include <QPaintEvent>
 #include <QKeyEvent>
 #include <QInputDialog>
+#include <QScreen>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <QtConcurrent>
+#include <algorithm>
 #include <cmath>
-#include <cstdlib>
-#include <ctime>
+#include <map>
 
 GameScene::GameScene(QWidget *parent)
-    : QWidget(parent), m_score(0), m_paused(false), m_frameCount(0), m_fps(0.0), 
-      m_gameState(GameState::Playing), m_lives(STARTING_LIVES), m_level(1),
-      m_invulnerable(false), m_invulnerabilityTimer(0.0),
-      m_paddleSizeTimer(0.0), m_ballSpeedTimer(0.0), m_powerUpTextTimer(0.0),
+    : QWidget(parent), m_simulation(nullptr), m_frame(nullptr), m_renderAlpha(1.0),
+      m_trailTick(0), m_paused(false), m_frameCount(0), m_fps(0.0), 
+      m_gameState(GameState::Playing), m_level(1), m_powerUpTextTimer(0.0),
       m_screenShakeAmount(0.0), m_screenShakeDuration(0.0),
-      m_highScoreManager(nullptr), m_levelManager(nullptr),
-      m_levelComplete(false), m_levelTransitionTimer(0.0)
+      m_shakeRandom(QRandomGenerator::global()->generate64()),
+      m_highScoreManager(nullptr), m_levelManager(nullptr), m_highScoreCheckPending(false),
+      m_levelComplete(false), m_levelTransitionTimer(0.0), m_replaying(false), m_replaySpeed(1),
+      m_autopilot(false), m_nextCaptureImage(0),
+      m_brickLayerId(0), m_brickLayerValid(false), m_brickFont("Arial", 10, QFont::Bold),
+      m_sceneAdvanced(false), m_fullRepaint(true), m_wasShaking(false),
+      m_scoreText(QFont("Arial", 18, QFont::Bold)),
+      m_levelText(QFont("Arial", 18, QFont::Bold)),
+      m_livesText(QFont("Arial", 18, QFont::Bold)),
+      m_bricksText(QFont("Arial", 12)),
+      m_fpsText(QFont("Arial", 10)),
+      m_levelInfoText(QFont("Arial", 12)),
+      m_powerUpBannerText(QFont("Arial", 20, QFont::Bold)),
+      m_pauseTitle(QFont("Arial", 48, QFont::Bold), "PAUSED"),
+      m_pauseHint(QFont("Arial", 16), "Press P or Space to resume"),
+      m_gameOverTitle(QFont("Arial", 48, QFont::Bold), "GAME OVER"),
+      m_finalScoreText(QFont("Arial", 20)),
+      m_restartHint(QFont("Arial", 16), "Press R to restart"),
+      m_victoryTitle(QFont("Arial", 48, QFont::Bold), "VICTORY!"),
+      m_victoryScoreText(QFont("Arial", 20)),
+      m_playAgainHint(QFont("Arial", 16), "Press R to play again"),
+      m_levelCompleteTitle(QFont("Arial", 48, QFont::Bold), "LEVEL COMPLETE!"),
+      m_nextLevelText(QFont("Arial", 24)),
+      m_countdownText(QFont("Arial", 16)),
+      m_replayText(QFont("Arial", 18, QFont::Bold)),
+      m_autopilotText(QFont("Arial", 18, QFont::Bold), "AUTOPILOT"),
+      m_showProfiler(false), m_profilerFont("Monospace", 9)
 {
     setMinimumSize(800, 600);
     setFocusPolicy(Qt::StrongFocus);
     
-    std::srand(std::time(nullptr));
+    Profiler::instance().setThreadName("GUI");
+    m_profilerFont.setStyleHint(QFont::Monospace);
     
-    m_paddle = std::make_unique<Paddle>(350.0, 550.0, 100.0, 15.0);
-    m_ball = std::make_unique<Ball>(400.0, 300.0, 8.0);
     m_soundManager = std::make_unique<SoundManager>(this);
     
+    m_simulation = new SimulationWorker();
+    m_simulation->moveToThread(&m_simulationThread);
+    connect(&m_simulationThread, &QThread::started, m_simulation, &SimulationWorker::start);
+    connect(&m_simulationThread, &QThread::finished, m_simulation, &QObject::deleteLater);
+    m_simulationThread.start();
+    m_frame = &m_simulation->frame();
+    postNewGame();  // Seeds the first game so it is recorded like every later one
+    
+    // Pre-render one trail dot; every trail point is drawn as a scaled,
+    // faded copy of it
+    m_trailSprite = QPixmap(TRAIL_SPRITE_RADIUS * 2, TRAIL_SPRITE_RADIUS * 2);
+    m_trailSprite.fill(Qt::transparent);
+    QPainter spritePainter(&m_trailSprite);
+    spritePainter.setRenderHint(QPainter::Antialiasing);
+    spritePainter.setPen(Qt::NoPen);
+    spritePainter.setBrush(QColor(150, 200, 255));
+    spritePainter.drawEllipse(m_trailSprite.rect());
+    spritePainter.end();
+    m_trailFragments.reserve(m_ballTrail.length());
+    
+    const QFont letterFont("Arial", 8, QFont::Bold);
+    for (int type = 0; type < PowerUp::TYPE_COUNT; ++type) {
+        m_powerUpLetters[type] = CachedText(letterFont, PowerUp::nameFor(static_cast<PowerUpType>(type)).left(1));
+    }
+    
     connect(&m_gameTimer, &QTimer::timeout, this, &GameScene::gameLoop);
-    m_gameTimer.start(static_cast<int>(FRAME_TIME));
+    m_gameTimer.setTimerType(Qt::PreciseTimer);
+    setFrameRateCap(DEFAULT_FRAME_RATE_CAP, false);
     m_elapsedTimer.start();
     m_fpsTimer.start();
+    m_profilerRefresh.start();
     
     m_soundManager->playBackgroundMusic();
 }
 
+GameScene::~GameScene()
+{
+    m_capture.stop();
+    m_prefetch.waitForFinished();
+    m_simulationThread.quit();
+    m_simulationThread.wait();
+}
+
 QPointF GameScene::screenToGame(const QPoint &screenPos) const
 {
     qreal scaleX = GAME_WIDTH / width();
@@ -60,9 +119,14 @@ QPoint GameScene::gameToScreen(const QPointF &gamePos) const
 
 void GameScene::paintEvent(QPaintEvent *event)
 {
+    ScopedTimer timer("Paint");
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
-    
+    renderScene(painter);
+}
+
+void GameScene::renderScene(QPainter &painter)
+{
     // Apply screen shake
     if (m_screenShakeDuration > 0.0) {
         painter.translate(m_screenShakeOffset);
@@ -89,6 +153,10 @@ void GameScene::paintEvent(QPaintEvent *event)
     } else if (m_gameState == GameState::Victory) {
         drawVictoryOverlay(painter);
     }
+    
+    if (m_showProfiler) {
+        drawProfilerOverlay(painter);
+    }
 }
 
 void GameScene::keyPressEvent(QKeyEvent *event)
@@ -115,8 +183,11 @@ void GameScene::keyReleaseEvent(QKeyEvent *event)
 
 void GameScene::gameLoop()
 {
-    qreal delta = m_elapsedTimer.elapsed() / 1000.0;
+    const qint64 frameTime = m_elapsedTimer.nsecsElapsed();
     m_elapsedTimer.restart();
+    qreal delta = frameTime / 1e9;
+    Profiler::instance().recordFrame(frameTime);
+    ScopedTimer timer("Frame update");
     
     m_frameCount++;
     if (m_fpsTimer.elapsed() >= 1000) {
@@ -125,16 +196,202 @@ void GameScene::gameLoop()
         m_fpsTimer.restart();
     }
     
+    receiveFrame();
+    processWorldEvents();
+    
     if (!m_paused && m_gameState == GameState::Playing) {
         updateGame(delta);
-        checkGameState();
     }
-    update();
+    sendInput();
+    
+    if (m_showProfiler && m_profilerRefresh.elapsed() >= 250) {
+        refreshProfilerStats();
+        m_pendingDamage += profilerRect();
+    }
+    
+    scheduleRepaint();
+    if (m_capture.isActive()) {
+        captureFrame();
+    }
+}
+
+void GameScene::receiveFrame()
+{
+    // Take events before the frame: the worker publishes a frame before
+    // queueing its events, so the frame is never older than an event
+    m_worldEvents.clear();
+    GameEvent event;
+    while (m_simulation->takeEvent(event)) {
+        m_worldEvents.push_back(event);
+    }
+    
+    const bool newFrame = m_simulation->updateFrame();
+    m_frame = &m_simulation->frame();
+    
+    // Fix the interpolation point once per frame so the damage region and
+    // the paint that follows agree on where everything is
+    m_renderAlpha = m_frame->alphaAt(m_simulation->now());
+    m_sceneAdvanced = m_sceneAdvanced || newFrame || m_frame->running;
+    
+    if (m_frame->tick != m_trailTick && !m_frame->ballPositions.empty()) {
+        m_ballTrail.push(m_frame->ballPositions[0]);
+        m_trailTick = m_frame->tick;
+    }
+}
+
+void GameScene::sendInput()
+{
+    if (m_replaying || m_autopilot) {
+        return;  // The replay or the autopilot supplies the input
+    }
+    
+    const PaddleInput input = currentInput();
+    if (input.left == m_sentInput.left && input.right == m_sentInput.right) {
+        return;
+    }
+    
+    WorldCommand command;
+    command.type = WorldCommand::Type::SetInput;
+    command.input = input;
+    if (m_simulation->post(command)) {
+        m_sentInput = input;
+    }
+}
+
+void GameScene::postCommand(WorldCommand::Type type)
+{
+    WorldCommand command;
+    command.type = type;
+    command.paused = m_paused;
+    m_simulation->post(command);
+}
+
+void GameScene::postNewGame()
+{
+    WorldCommand command;
+    command.type = WorldCommand::Type::NewGame;
+    command.seed = QRandomGenerator::global()->generate();
+    m_simulation->post(command);
+}
+
+void GameScene::scheduleRepaint()
+{
+    // Shake translates the whole scene, and state changes swap overlays
+    const bool shaking = m_screenShakeDuration > 0.0;
+    if (m_fullRepaint || shaking || m_wasShaking) {
+        m_dynamicRegion = dynamicRegion();
+        m_pendingDamage = QRegion();
+        hudDamage();
+        m_sceneAdvanced = false;
+        m_fullRepaint = false;
+        m_wasShaking = shaking;
+        update();
+        return;
+    }
+    
+    QRegion dirty = hudDamage() + m_pendingDamage;
+    
+    // Nothing moves unless the scene advanced, so a paused or finished game
+    // only repaints when HUD text changes
+    if (m_sceneAdvanced) {
+        QRegion dynamic = dynamicRegion();
+        dirty += dynamic + m_dynamicRegion;
+        m_dynamicRegion = dynamic;
+    }
+    
+    m_pendingDamage = QRegion();
+    m_sceneAdvanced = false;
+    
+    if (!dirty.isEmpty()) {
+        update(dirty);
+    }
+}
+
+QRegion GameScene::dynamicRegion() const
+{
+    QRegion region;
+    const qreal scaleX = width() / GAME_WIDTH;
+    
+    region += damageRect(m_frame->paddleAt(m_renderAlpha), 2);
+    
+    for (size_t i = 0; i < m_frame->ballPositions.size(); ++i) {
+        const qreal r = m_frame->ballRadii[i];
+        const QPointF center = m_frame->ballAt(static_cast<int>(i), m_renderAlpha);
+        QRectF ballRect(center.x() - r, center.y() - r, r * 2, r * 2);
+        region += damageRect(ballRect, static_cast<int>(r * scaleX) + 2);
+    }
+    
+    // The trail and particles are covered by their bounding boxes; their dots
+    // are drawn in screen pixels, so pad by the largest dot radius
+    if (!m_ballTrail.isEmpty()) {
+        QRectF trailBounds(m_ballTrail.at(0), QSizeF(0, 0));
+        for (int i = 1; i < m_ballTrail.size(); ++i) {
+            trailBounds |= QRectF(m_ballTrail.at(i), QSizeF(0, 0));
+        }
+        region += damageRect(trailBounds, static_cast<int>(GameWorld::BALL_RADIUS) + 2);
+    }
+    
+    const auto &particles = m_frame->particles;
+    if (!particles.empty()) {
+        QRectF particleBounds(particles[0].position, QSizeF(0, 0));
+        for (size_t i = 1; i < particles.size(); ++i) {
+            particleBounds |= QRectF(particles[i].position, QSizeF(0, 0));
+        }
+        region += damageRect(particleBounds, 7);
+    }
+    
+    for (size_t i = 0; i < m_frame->powerUps.size(); ++i) {
+        region += damageRect(m_frame->powerUpAt(static_cast<int>(i), m_renderAlpha), 2);
+    }
+    
+    return region;
+}
+
+QRegion GameScene::hudDamage()
+{
+    HudState state;
+    state.score = m_frame->score;
+    state.lives = m_frame->lives;
+    state.level = m_level;
+    state.bricks = m_frame->bricks.activeCount();
+    state.fpsTenths = qRound(m_fps * 10.0);
+    state.countdownTenths = m_levelComplete ? qRound(m_levelTransitionTimer * 10.0) : -1;
+    state.powerUpText = m_powerUpTextTimer > 0.0 ? m_activePowerUpText : QString();
+    state.replaying = m_replaying;
+    state.autopilot = m_autopilot;
+    
+    QRegion damage;
+    
+    if (state.score != m_hudState.score || state.lives != m_hudState.lives ||
+        state.level != m_hudState.level || state.replaying != m_hudState.replaying ||
+        state.autopilot != m_hudState.autopilot) {
+        damage += QRect(0, 0, width(), 45);
+    }
+    if (state.bricks != m_hudState.bricks || state.fpsTenths != m_hudState.fpsTenths) {
+        damage += QRect(0, height() - 60, 250, 60);
+    }
+    if (state.powerUpText != m_hudState.powerUpText) {
+        damage += QRect(0, height() / 2 - 50, width(), 50);
+    }
+    if (state.countdownTenths != m_hudState.countdownTenths) {
+        damage += QRect(0, height() / 2 + 80, width(), 60);
+    }
+    
+    m_hudState = state;
+    return damage;
+}
+
+QRect GameScene::damageRect(const QRectF &gameRect, int margin) const
+{
+    QRect screenRect(gameToScreen(gameRect.topLeft()), gameToScreen(gameRect.bottomRight()));
+    return screenRect.normalized().adjusted(-margin, -margin, margin + 1, margin + 1);
 }
 
 void GameScene::togglePause()
 {
     m_paused = !m_paused;
+    m_fullRepaint = true;
+    postCommand(WorldCommand::Type::SetPaused);
 }
 
 void GameScene::startNewGame()
@@ -144,30 +401,22 @@ void GameScene::startNewGame()
 
 void GameScene::restartGame()
 {
-    m_score = 0;
     m_paused = false;
+    m_fullRepaint = true;
     m_gameState = GameState::Playing;
-    m_lives = STARTING_LIVES;
     m_level = 1;
-    m_invulnerable = false;
-    m_invulnerabilityTimer = 0.0;
-    m_paddleSizeTimer = 0.0;
-    m_ballSpeedTimer = 0.0;
     m_powerUpTextTimer = 0.0;
+    m_replaying = false;
     
-    m_paddle->setPosition(350.0, 550.0);
-    m_paddle->setWidth(100.0);
-    resetBall();
+    postCommand(WorldCommand::Type::SetPaused);
+    postNewGame();
     
     if (m_levelManager) {
         m_levelManager->resetToLevel(1);
     }
     
-    m_bricks.clear();
     loadCurrentLevel();
     
-    m_powerUps.clear();
-    m_particles.clear();
     m_ballTrail.clear();
     m_screenShakeAmount = 0.0;
     m_screenShakeDuration = 0.0;
@@ -178,65 +427,19 @@ void GameScene::resetGame()
 {
     // Reset game state but keep score and level
     m_paused = false;
+    m_fullRepaint = true;
     m_gameState = GameState::Playing;
-    m_invulnerable = false;
-    m_invulnerabilityTimer = 0.0;
-    m_paddleSizeTimer = 0.0;
-    m_ballSpeedTimer = 0.0;
     m_powerUpTextTimer = 0.0;
     
-    m_paddle->setPosition(350.0, 550.0);
-    m_paddle->setWidth(100.0);
-    resetBall();
+    postCommand(WorldCommand::Type::SetPaused);
+    postCommand(WorldCommand::Type::ResetRound);
     
-    m_powerUps.clear();
-    m_particles.clear();
     m_ballTrail.clear();
     m_screenShakeAmount = 0.0;
     m_screenShakeDuration = 0.0;
     m_screenShakeOffset = QPointF(0, 0);
 }
 
-void GameScene::resetBall()
-{
-    m_ball = std::make_unique<Ball>(400.0, 300.0, 8.0);
-    
-    // Use level-specific ball speed if available
-    qreal ballSpeed = 200.0;
-    if (m_levelManager) {
-        const Level *level = m_levelManager->getCurrentLevel();
-        if (level && level->ballSpeed() > 0.0) {
-            ballSpeed = level->ballSpeed();
-        }
-    }
-    
-    // Set velocity at 45-degree angle (downward and to the right)
-    qreal vx = ballSpeed * 0.707;
-    qreal vy = -ballSpeed * 0.707;
-    m_ball->setVelocity(vx, vy);
-}
-
-void GameScene::loseLife()
-{
-    m_lives--;
-    m_soundManager->playSound(SoundManager::Sound::LoseLife);
-    
-    // Big screen shake on life loss
-    m_screenShakeAmount = 8.0;
-    m_screenShakeDuration = 0.3;
-    
-    if (m_lives <= 0) {
-        m_gameState = GameState::GameOver;
-        m_soundManager->playSound(SoundManager::Sound::GameOver);
-        checkForHighScore();
-    } else {
-        m_paddle->setPosition(350.0, 550.0);
-        resetBall();
-        m_invulnerable = true;
-        m_invulnerabilityTimer = INVULNERABILITY_TIME;
-    }
-}
-
 void GameScene::updateGame(qreal delta)
 {
     // Handle level transition
@@ -252,219 +455,99 @@ void GameScene::updateGame(qreal delta)
         return; // Don't update game during transition
     }
     
-    if (m_invulnerable) {
-        m_invulnerabilityTimer -= delta;
-        if (m_invulnerabilityTimer <= 0.0) {
-            m_invulnerable = false;
-            m_invulnerabilityTimer = 0.0;
-        }
-    }
-    
-    if (m_paddleSizeTimer > 0.0) {
-        m_paddleSizeTimer -= delta;
-        if (m_paddleSizeTimer <= 0.0) {
-            m_paddle->setWidth(100.0);
-            m_paddleSizeTimer = 0.0;
-        }
-    }
-    
-    if (m_ballSpeedTimer > 0.0) {
-        m_ballSpeedTimer -= delta;
-        if (m_ballSpeedTimer <= 0.0) {
-            QPointF vel = m_ball->velocity();
-            qreal currentSpeed = std::sqrt(vel.x() * vel.x() + vel.y() * vel.y());
-            qreal normalSpeed = 300.0;
-            if (currentSpeed > 0.0) {
-                qreal scale = normalSpeed / currentSpeed;
-                m_ball->setVelocity(vel.x() * scale, vel.y() * scale);
-            }
-            m_ballSpeedTimer = 0.0;
-        }
-    }
-    
     if (m_powerUpTextTimer > 0.0) {
         m_powerUpTextTimer -= delta;
     }
     
+    m_sceneAdvanced = true;
     updateScreenShake(delta);
-    
-    // Update particles
-    for (auto &particle : m_particles) {
-        particle.update(delta);
-    }
-    m_particles.erase(
-        std::remove_if(m_particles.begin(), m_particles.end(),
-            [](const Particle &p) { return !p.isAlive(); }),
-        m_particles.end()
-    );
-    
-    // Update ball trail
-    m_ballTrail.push_back(m_ball->position());
-    if (m_ballTrail.size() > 10) {
-        m_ballTrail.erase(m_ballTrail.begin());
-    }
-    
-    if (m_pressedKeys.contains(Qt::Key_A) || m_pressedKeys.contains(Qt::Key_Left)) {
-        m_paddle->moveLeft(delta);
-    }
-    if (m_pressedKeys.contains(Qt::Key_D) || m_pressedKeys.contains(Qt::Key_Right)) {
-        m_paddle->moveRight(delta);
-    }
-    
-    m_paddle->constrainToBounds(0, GAME_WIDTH);
-    
-    m_ball->move(delta);
-    m_ball->checkBoundaryCollision(0, GAME_WIDTH, 0, GAME_HEIGHT);
-    
-    for (auto &powerUp : m_powerUps) {
-        if (powerUp->isActive()) {
-            powerUp->move(delta);
-            if (powerUp->rect().top() > GAME_HEIGHT) {
-                powerUp->setActive(false);
-            }
-        }
-    }
-    
-    if (!m_invulnerable) {
-        checkBallPaddleCollision();
-    }
-    checkBallBrickCollisions();
-    checkPowerUpCollisions();
 }
 
-void GameScene::checkGameState()
+PaddleInput GameScene::currentInput() const
 {
-    if (m_ball->y() > GAME_HEIGHT) {
-        loseLife();
-    }
-    
-    bool allBricksDestroyed = true;
-    for (const auto &brick : m_bricks) {
-        if (brick->isActive()) {
-            allBricksDestroyed = false;
-            break;
-        }
-    }
-    
-    if (allBricksDestroyed && !m_levelComplete) {
-        // Check if there's a next level
-        if (m_levelManager && m_levelManager->hasNextLevel()) {
-            completeLevel();
-        } else {
-            // No more levels - game won
-            m_gameState = GameState::Victory;
-            m_soundManager->playSound(SoundManager::Sound::Victory);
-            checkForHighScore();
-        }
-    }
+    PaddleInput input;
+    input.left = m_pressedKeys.contains(Qt::Key_A) || m_pressedKeys.contains(Qt::Key_Left);
+    input.right = m_pressedKeys.contains(Qt::Key_D) || m_pressedKeys.contains(Qt::Key_Right);
+    return input;
 }
 
-void GameScene::checkBallPaddleCollision()
+void GameScene::processWorldEvents()
 {
-    QRectF paddleRect = m_paddle->rect();
-    QPointF ballPos = m_ball->position();
-    qreal ballRadius = m_ball->radius();
-    
-    if (ballPos.y() + ballRadius >= paddleRect.top() &&
-        ballPos.y() - ballRadius <= paddleRect.bottom() &&
-        ballPos.x() + ballRadius >= paddleRect.left() &&
-        ballPos.x() - ballRadius <= paddleRect.right()) {
-        
-        qreal hitPos = (ballPos.x() - paddleRect.left()) / paddleRect.width();
-        hitPos = qBound(0.0, hitPos, 1.0);
-        
-        qreal angle = (hitPos - 0.5) * 2.0;
-        qreal speed = std::sqrt(m_ball->velocity().x() * m_ball->velocity().x() + 
-                               m_ball->velocity().y() * m_ball->velocity().y());
-        
-        qreal newVx = angle * speed * 0.8;
-        qreal newVy = -std::abs(speed * 0.8);
-        
-        m_ball->setVelocity(newVx, newVy);
-        m_soundManager->playSound(SoundManager::Sound::BallHit);
-    }
-}
-
-void GameScene::checkBallBrickCollisions()
-{
-    QPointF ballPos = m_ball->position();
-    qreal ballRadius = m_ball->radius();
-    
-    for (auto &brick : m_bricks) {
-        if (!brick->isActive()) continue;
-        
-        QRectF brickRect = brick->rect();
-        
-        if (ballPos.x() + ballRadius >= brickRect.left() &&
-            ballPos.x() - ballRadius <= brickRect.right() &&
-            ballPos.y() + ballRadius >= brickRect.top() &&
-            ballPos.y() - ballRadius <= brickRect.bottom()) {
-            
-            bool destroyed = brick->hit();
-            m_score += destroyed ? 10 : 5;  // Less points for just damaging
-            m_soundManager->playSound(SoundManager::Sound::BrickBreak);
-            
-            // Spawn particles for brick destruction/damage
-            if (destroyed) {
-                spawnParticles(brickRect.center().x(), brickRect.center().y(), brick->color(), 15);
-                spawnPowerUp(brickRect.center().x(), brickRect.center().y());
+    // Iterate a copy: anything that spins an event loop in here would let
+    // gameLoop() refill m_worldEvents underneath the loop
+    std::vector<GameEvent> events;
+    events.swap(m_worldEvents);
+    
+    for (const GameEvent &event : events) {
+        switch (event.type) {
+            case GameEvent::Type::PaddleHit:
+                m_soundManager->playSound(SoundManager::Sound::BallHit);
+                break;
                 
-                // Add screen shake
+            case GameEvent::Type::BrickHit:
+                markBrickDirty(event.brick);
+                m_soundManager->playSound(SoundManager::Sound::BrickBreak);
+                break;
+                
+            case GameEvent::Type::BrickDestroyed:
+                markBrickDirty(event.brick);
+                m_soundManager->playSound(SoundManager::Sound::BrickBreak);
                 m_screenShakeAmount = 3.0;
                 m_screenShakeDuration = 0.1;
-            } else {
-                // Smaller effect for damage
-                spawnParticles(brickRect.center().x(), brickRect.center().y(), brick->color(), 5);
-            }
-            
-            qreal brickCenterX = brickRect.center().x();
-            qreal brickCenterY = brickRect.center().y();
-            
-            qreal dx = ballPos.x() - brickCenterX;
-            qreal dy = ballPos.y() - brickCenterY;
-            
-            if (std::abs(dx / brickRect.width()) > std::abs(dy / brickRect.height())) {
-                m_ball->reverseX();
-            } else {
-                m_ball->reverseY();
-            }
-            
-            break;
+                break;
+                
+            case GameEvent::Type::PowerUpCollected:
+                m_soundManager->playSound(SoundManager::Sound::PowerUp);
+                m_activePowerUpText = PowerUp::nameFor(event.powerUp) + "!";
+                m_powerUpBannerText.setText(m_activePowerUpText);
+                m_powerUpTextTimer = 2.0;
+                break;
+                
+            case GameEvent::Type::LifeLost:
+                m_soundManager->playSound(SoundManager::Sound::LoseLife);
+                // Big screen shake on life loss
+                m_screenShakeAmount = 8.0;
+                m_screenShakeDuration = 0.3;
+                break;
+                
+            case GameEvent::Type::GameOver:
+                m_gameState = GameState::GameOver;
+                m_fullRepaint = true;
+                m_soundManager->playSound(SoundManager::Sound::GameOver);
+                if (!m_replaying) {
+                    scheduleHighScoreCheck();
+                }
+                break;
+                
+            case GameEvent::Type::LevelCleared:
+                // A replay loads the next level itself at the recorded tick
+                if (m_replaying) {
+                    break;
+                }
+                
+                // Check if there's a next level
+                if (m_levelManager && m_levelManager->hasNextLevel()) {
+                    completeLevel();
+                } else {
+                    // No more levels - game won
+                    m_gameState = GameState::Victory;
+                    m_fullRepaint = true;
+                    m_soundManager->playSound(SoundManager::Sound::Victory);
+                    scheduleHighScoreCheck();
+                }
+                break;
         }
     }
-}
-
-void GameScene::createBricks()
-{
-    m_bricks.clear();
     
-    if (!m_levelManager) {
-        return;
-    }
-    
-    const Level *level = m_levelManager->getCurrentLevel();
-    if (!level) {
-        return;
-    }
-    
-    const qreal brickWidth = 70.0;
-    const qreal brickHeight = 25.0;
-    const qreal padding = 5.0;
-    const int maxCols = 10;
-    const qreal offsetX = (GAME_WIDTH - (maxCols * (brickWidth + padding) - padding)) / 2.0;
-    const qreal offsetY = 50.0;
-    
-    // Load bricks from level data
-    for (const auto &brickData : level->bricks()) {
-        qreal x = offsetX + brickData.col * (brickWidth + padding);
-        qreal y = offsetY + brickData.row * (brickHeight + padding);
-        m_bricks.push_back(std::make_unique<Brick>(x, y, brickWidth, brickHeight, 
-                                                    brickData.color, brickData.hitPoints));
-    }
+    // Hand the buffer back so receiveFrame() keeps reusing its capacity
+    events.clear();
+    m_worldEvents.swap(events);
 }
 
 void GameScene::drawBackground(QPainter &painter)
 {
+    ScopedTimer timer("drawBackground");
+    
     QLinearGradient gradient(0, 0, 0, height());
     gradient.setColorAt(0, QColor(20, 30, 48));
     gradient.setColorAt(1, QColor(36, 59, 85));
@@ -474,11 +557,14 @@ void GameScene::drawBackground(QPainter &painter)
 
 void GameScene::drawPaddle(QPainter &painter)
 {
-    if (m_invulnerable && static_cast<int>(m_invulnerabilityTimer * 10) % 2 == 0) {
+    ScopedTimer timer("drawPaddle");
+    
+    bool invulnerable = m_frame->invulnerable;
+    if (invulnerable && static_cast<int>(m_frame->invulnerabilityTimer * 10) % 2 == 0) {
         return;
     }
     
-    QRectF paddleRect = m_paddle->rect();
+    QRectF paddleRect = m_frame->paddleAt(m_renderAlpha);
     QPoint screenPos = gameToScreen(paddleRect.topLeft());
     QPoint screenBottomRight = gameToScreen(paddleRect.bottomRight());
     
@@ -486,7 +572,7 @@ void GameScene::drawPaddle(QPainter &painter)
     
     QLinearGradient gradient(screenRect.topLeft(), screenRect.bottomLeft());
     
-    if (m_invulnerable) {
+    if (invulnerable) {
         gradient.setColorAt(0, QColor(255, 200, 100));
         gradient.setColorAt(1, QColor(255, 150, 50));
     } else {
@@ -495,269 +581,296 @@ void GameScene::drawPaddle(QPainter &painter)
     }
     
     painter.setBrush(gradient);
-    painter.setPen(QPen(m_invulnerable ? QColor(255, 230, 200) : QColor(200, 230, 255), 2));
+    painter.setPen(QPen(invulnerable ? QColor(255, 230, 200) : QColor(200, 230, 255), 2));
     painter.drawRoundedRect(screenRect, 5, 5);
 }
 
 void GameScene::drawBall(QPainter &painter)
 {
-    QPoint screenPos = gameToScreen(m_ball->position());
-    qreal screenRadius = m_ball->radius() * (width() / GAME_WIDTH);
+    ScopedTimer timer("drawBall");
     
-    QRadialGradient gradient(screenPos, screenRadius);
-    gradient.setColorAt(0, Qt::white);
-    gradient.setColorAt(1, QColor(200, 200, 255));
-    
-    painter.setBrush(gradient);
     painter.setPen(QPen(QColor(150, 150, 255), 2));
-    painter.drawEllipse(screenPos, static_cast<int>(screenRadius), static_cast<int>(screenRadius));
+    
+    for (size_t i = 0; i < m_frame->ballPositions.size(); ++i) {
+        QPoint screenPos = gameToScreen(m_frame->ballAt(static_cast<int>(i), m_renderAlpha));
+        qreal screenRadius = m_frame->ballRadii[i] * (width() / GAME_WIDTH);
+        
+        QRadialGradient gradient(screenPos, screenRadius);
+        gradient.setColorAt(0, Qt::white);
+        gradient.setColorAt(1, QColor(200, 200, 255));
+        
+        painter.setBrush(gradient);
+        painter.drawEllipse(screenPos, static_cast<int>(screenRadius), static_cast<int>(screenRadius));
+    }
 }
 
 void GameScene::drawBricks(QPainter &painter)
 {
-    for (const auto &brick : m_bricks) {
-        if (!brick->isActive()) continue;
-        
-        QRectF brickRect = brick->rect();
-        QPoint screenPos = gameToScreen(brickRect.topLeft());
-        QPoint screenBottomRight = gameToScreen(brickRect.bottomRight());
-        QRectF screenRect(screenPos, screenBottomRight);
-        
-        QLinearGradient gradient(screenRect.topLeft(), screenRect.bottomLeft());
-        QColor color = brick->currentColor();  // Use currentColor for damage indication
-        gradient.setColorAt(0, color.lighter(120));
-        gradient.setColorAt(1, color);
+    ScopedTimer timer("drawBricks");
+    
+    updateBrickLayer();
+    painter.drawImage(0, 0, m_brickLayer);
+}
+
+void GameScene::updateBrickLayer()
+{
+    const qreal dpr = devicePixelRatioF();
+    const QSize pixelSize = size() * dpr;
+    
+    if (!m_brickLayerValid || m_brickLayerId != m_frame->brickLayoutId ||
+        m_brickLayer.size() != pixelSize) {
+        // A prefetched level arrives with its layer already painted; it only
+        // fits an untouched brick set at the size it was painted for
+        if (m_brickLayerId != m_frame->brickLayoutId && m_preparedBrickLayer.size() == pixelSize &&
+            m_frame->bricks.activeCount() == m_frame->bricks.size()) {
+            m_brickLayer.swap(m_preparedBrickLayer);
+        } else {
+            m_brickLayer = renderBrickLayer(m_frame->bricks, size(), dpr, m_brickFont);
+        }
+        m_preparedBrickLayer = QImage();
         
-        painter.setBrush(gradient);
-        painter.setPen(QPen(color.darker(150), 2));
-        painter.drawRoundedRect(screenRect, 3, 3);
+        m_brickLayerId = m_frame->brickLayoutId;
+        m_brickLayerValid = true;
+        m_dirtyBricks.clear();
+        return;
+    }
+    
+    if (m_dirtyBricks.empty()) {
+        return;
+    }
+    
+    QPainter layerPainter(&m_brickLayer);
+    layerPainter.setRenderHint(QPainter::Antialiasing);
+    
+    for (int dirty : m_dirtyBricks) {
+        // Cover the outline pen and antialiasing fringe too
+        const QRectF area = brickScreenRect(dirty).adjusted(-2, -2, 2, 2);
+        layerPainter.setClipRect(area);
+        layerPainter.setCompositionMode(QPainter::CompositionMode_Source);
+        layerPainter.fillRect(area, Qt::transparent);
+        layerPainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
         
-        // Draw hit points indicator for multi-hit bricks
-        if (brick->maxHitPoints() > 1) {
-            painter.setPen(Qt::white);
-            painter.setFont(QFont("Arial", 10, QFont::Bold));
-            painter.drawText(screenRect, Qt::AlignCenter, QString::number(brick->hitPoints()));
-        }
+        // Repaint whatever still lives in the patch, neighbours included
+        m_frame->bricks.forEachActive([&](int index) {
+            if (brickScreenRect(index).adjusted(-2, -2, 2, 2).intersects(area)) {
+                paintBrick(layerPainter, index);
+            }
+        });
     }
+    
+    m_dirtyBricks.clear();
 }
 
-void GameScene::drawScore(QPainter &painter)
+QImage GameScene::renderBrickLayer(const BrickField &bricks, const QSize &sceneSize, qreal dpr, const QFont &font)
 {
-    painter.setPen(Qt::white);
-    painter.setFont(QFont("Arial", 16, QFont::Bold));
-    painter.drawText(10, 25, QString("Score: %1").arg(m_score));
+    QImage layer(sceneSize * dpr, QImage::Format_ARGB32_Premultiplied);
+    layer.setDevicePixelRatio(dpr);
+    layer.fill(Qt::transparent);
+    
+    QPainter layerPainter(&layer);
+    layerPainter.setRenderHint(QPainter::Antialiasing);
+    bricks.forEachActive([&](int index) {
+        paintBrick(layerPainter, bricks, index, sceneSize, font);
+    });
+    return layer;
+}
+
+void GameScene::paintBrick(QPainter &painter, int index) const
+{
+    paintBrick(painter, m_frame->bricks, index, size(), m_brickFont);
+}
+
+void GameScene::paintBrick(QPainter &painter, const BrickField &bricks, int index, const QSize &sceneSize,
+                           const QFont &font)
+{
+    QRectF screenRect = brickScreenRect(bricks, index, sceneSize);
+    
+    QLinearGradient gradient(screenRect.topLeft(), screenRect.bottomLeft());
+    QColor color = bricks.currentColor(index);  // Use currentColor for damage indication
+    gradient.setColorAt(0, color.lighter(120));
+    gradient.setColorAt(1, color);
     
-    int activeBricks = 0;
-    for (const auto &brick : m_bricks) {
-        if (brick->isActive()) activeBricks++;
+    painter.setBrush(gradient);
+    painter.setPen(QPen(color.darker(150), 2));
+    painter.drawRoundedRect(screenRect, 3, 3);
+    
+    // Draw hit points indicator for multi-hit bricks
+    if (bricks.maxHitPoints(index) > 1) {
+        painter.setPen(Qt::white);
+        painter.setFont(font);
+        painter.drawText(screenRect, Qt::AlignCenter, QString::number(bricks.hitPoints(index)));
+    }
+}
+
+void GameScene::markBrickDirty(int index)
+{
+    // Events can trail a level change by a frame; ignore stale indices
+    if (index < 0 || index >= m_frame->bricks.size()) {
+        return;
     }
-    painter.drawText(width() - 150, 25, QString("Bricks: %1").arg(activeBricks));
+    
+    m_dirtyBricks.push_back(index);
+    m_pendingDamage += brickScreenRect(index).toAlignedRect().adjusted(-2, -2, 2, 2);
+}
+
+QRectF GameScene::brickScreenRect(int index) const
+{
+    return brickScreenRect(m_frame->bricks, index, size());
+}
+
+QRectF GameScene::brickScreenRect(const BrickField &bricks, int index, const QSize &sceneSize)
+{
+    // Same truncation as gameToScreen()
+    const qreal scaleX = sceneSize.width() / GAME_WIDTH;
+    const qreal scaleY = sceneSize.height() / GAME_HEIGHT;
+    const QRectF brickRect = bricks.rect(index);
+    return QRectF(QPoint(static_cast<int>(brickRect.left() * scaleX), static_cast<int>(brickRect.top() * scaleY)),
+                  QPoint(static_cast<int>(brickRect.right() * scaleX), static_cast<int>(brickRect.bottom() * scaleY)));
 }
 
 void GameScene::drawHUD(QPainter &painter)
 {
+    ScopedTimer timer("drawHUD");
+    
     QRect topPanel(0, 0, width(), 45);
     painter.fillRect(topPanel, QColor(0, 0, 0, 120));
     
-    painter.setPen(Qt::white);
-    painter.setFont(QFont("Arial", 18, QFont::Bold));
-    painter.drawText(15, 28, QString("Score: %1").arg(m_score));
+    const int score = m_frame->score;
+    const int lives = m_frame->lives;
+    const int bricks = m_frame->bricks.activeCount();
+    m_scoreText.update(score, [&] { return QString("Score: %1").arg(score); });
+    m_levelText.update(m_level, [&] { return QString("Level: %1").arg(m_level); });
+    m_livesText.update(lives, [&] { return QString("Lives: %1").arg(lives); });
+    m_bricksText.update(bricks, [&] { return QString("Bricks: %1").arg(bricks); });
     
-    painter.drawText(width() / 2 - 50, 28, QString("Level: %1").arg(m_level));
+    painter.setPen(Qt::white);
+    m_scoreText.draw(painter, 15, 28);
+    if (m_replaying) {
+        m_replayText.update(m_replaySpeed, [&] { return QString("REPLAY x%1").arg(m_replaySpeed); });
+        painter.setPen(QColor(255, 200, 80));
+        m_replayText.draw(painter, width() / 2 - 60, 28);
+    } else if (m_autopilot) {
+        painter.setPen(QColor(120, 220, 160));
+        m_autopilotText.draw(painter, width() / 2 - 60, 28);
+    } else {
+        m_levelText.draw(painter, width() / 2 - 50, 28);
+    }
     
     painter.setPen(QColor(255, 100, 100));
-    QString livesText = QString("Lives: %1").arg(m_lives);
-    painter.drawText(width() - 130, 28, livesText);
-    
-    int activeBricks = 0;
-    for (const auto &brick : m_bricks) {
-        if (brick->isActive()) activeBricks++;
-    }
+    m_livesText.draw(painter, width() - 130, 28);
     
     painter.setPen(QColor(150, 200, 255));
-    painter.setFont(QFont("Arial", 12));
-    painter.drawText(15, height() - 35, QString("Bricks: %1").arg(activeBricks));
+    m_bricksText.draw(painter, 15, height() - 35);
 }
 
 void GameScene::drawFPS(QPainter &painter)
 {
+    ScopedTimer timer("drawFPS");
+    
+    m_fpsText.update(qRound(m_fps * 10.0), [&] { return QString("FPS: %1").arg(m_fps, 0, 'f', 1); });
+    
     painter.setPen(QColor(200, 200, 200));
-    painter.setFont(QFont("Arial", 10));
-    painter.drawText(10, height() - 10, QString("FPS: %1").arg(m_fps, 0, 'f', 1));
+    m_fpsText.draw(painter, 10, height() - 10);
 }
 
 void GameScene::drawPauseOverlay(QPainter &painter)
 {
+    ScopedTimer timer("drawPauseOverlay");
+    
     painter.fillRect(rect(), QColor(0, 0, 0, 150));
     
     painter.setPen(Qt::white);
-    painter.setFont(QFont("Arial", 48, QFont::Bold));
-    painter.drawText(rect(), Qt::AlignCenter, "PAUSED");
+    m_pauseTitle.drawCentered(painter, rect());
     
-    painter.setFont(QFont("Arial", 16));
     QRect textRect = rect();
     textRect.translate(0, 60);
-    painter.drawText(textRect, Qt::AlignCenter, "Press P or Space to resume");
+    m_pauseHint.drawCentered(painter, textRect);
 }
 
 void GameScene::drawGameOverOverlay(QPainter &painter)
 {
+    ScopedTimer timer("drawGameOverOverlay");
+    
     painter.fillRect(rect(), QColor(0, 0, 0, 180));
     
     painter.setPen(QColor(255, 100, 100));
-    painter.setFont(QFont("Arial", 48, QFont::Bold));
-    painter.drawText(rect(), Qt::AlignCenter, "GAME OVER");
+    m_gameOverTitle.drawCentered(painter, rect());
+    
+    const int score = m_frame->score;
+    m_finalScoreText.update(score, [&] { return QString("Final Score: %1").arg(score); });
     
     painter.setPen(Qt::white);
-    painter.setFont(QFont("Arial", 20));
     QRect textRect = rect();
     textRect.translate(0, 60);
-    painter.drawText(textRect, Qt::AlignCenter, QString("Final Score: %1").arg(m_score));
+    m_finalScoreText.drawCentered(painter, textRect);
     
-    painter.setFont(QFont("Arial", 16));
     textRect.translate(0, 40);
-    painter.drawText(textRect, Qt::AlignCenter, "Press R to restart");
+    m_restartHint.drawCentered(painter, textRect);
 }
 
 void GameScene::drawVictoryOverlay(QPainter &painter)
 {
+    ScopedTimer timer("drawVictoryOverlay");
+    
     painter.fillRect(rect(), QColor(0, 0, 0, 180));
     
     painter.setPen(QColor(100, 255, 100));
-    painter.setFont(QFont("Arial", 48, QFont::Bold));
-    painter.drawText(rect(), Qt::AlignCenter, "VICTORY!");
+    m_victoryTitle.drawCentered(painter, rect());
+    
+    const int score = m_frame->score;
+    m_victoryScoreText.update(score, [&] { return QString("Score: %1").arg(score); });
     
     painter.setPen(Qt::white);
-    painter.setFont(QFont("Arial", 20));
     QRect textRect = rect();
     textRect.translate(0, 60);
-    painter.drawText(textRect, Qt::AlignCenter, QString("Score: %1").arg(m_score));
+    m_victoryScoreText.drawCentered(painter, textRect);
     
-    painter.setFont(QFont("Arial", 16));
     textRect.translate(0, 40);
-    painter.drawText(textRect, Qt::AlignCenter, "Press R to play again");
+    m_playAgainHint.drawCentered(painter, textRect);
 }
 
 void GameScene::drawLevelTransitionOverlay(QPainter &painter)
 {
+    ScopedTimer timer("drawLevelTransitionOverlay");
+    
     painter.fillRect(rect(), QColor(0, 0, 0, 150));
     
     painter.setPen(QColor(100, 200, 255));
-    painter.setFont(QFont("Arial", 48, QFont::Bold));
-    painter.drawText(rect(), Qt::AlignCenter, "LEVEL COMPLETE!");
+    m_levelCompleteTitle.drawCentered(painter, rect());
     
     if (m_levelManager) {
-        const Level *nextLevel = nullptr;
         int nextLevelNum = m_levelManager->currentLevelNumber() + 1;
+        m_nextLevelText.update(nextLevelNum, [&] { return QString("Next Level: %1").arg(nextLevelNum); });
+        m_countdownText.update(qRound(m_levelTransitionTimer * 10.0), [&] {
+            return QString("Get ready... %1").arg(m_levelTransitionTimer, 0, 'f', 1);
+        });
         
         // Preview next level info
         painter.setPen(Qt::white);
-        painter.setFont(QFont("Arial", 24));
         QRect textRect = rect();
         textRect.translate(0, 70);
-        painter.drawText(textRect, Qt::AlignCenter, QString("Next Level: %1").arg(nextLevelNum));
+        m_nextLevelText.drawCentered(painter, textRect);
         
-        painter.setFont(QFont("Arial", 16));
         textRect.translate(0, 40);
-        painter.drawText(textRect, Qt::AlignCenter, 
-                        QString("Get ready... %1").arg(m_levelTransitionTimer, 0, 'f', 1));
-    }
-}
-
-
-void GameScene::spawnPowerUp(qreal x, qreal y)
-{
-    if (std::rand() % 100 < 20) {
-        PowerUpType type = static_cast<PowerUpType>(std::rand() % 5);
-        m_powerUps.push_back(std::make_unique<PowerUp>(x, y, type));
-    }
-}
-
-void GameScene::checkPowerUpCollisions()
-{
-    QRectF paddleRect = m_paddle->rect();
-    
-    for (auto &powerUp : m_powerUps) {
-        if (!powerUp->isActive()) continue;
-        
-        QRectF powerUpRect = powerUp->rect();
-        
-        if (paddleRect.intersects(powerUpRect)) {
-            // Spawn particles when power-up is collected
-            spawnParticles(powerUpRect.center().x(), powerUpRect.center().y(), 
-                          powerUp->color(), 10);
-            applyPowerUp(powerUp->type());
-            powerUp->setActive(false);
-        }
-    }
-}
-
-void GameScene::applyPowerUp(PowerUpType type)
-{
-    const qreal DURATION = 10.0;
-    m_soundManager->playSound(SoundManager::Sound::PowerUp);
-    
-    switch (type) {
-        case PowerUpType::BiggerPaddle:
-            if (m_paddleSizeTimer <= 0.0) {
-                m_paddle->setWidth(m_paddle->width() * 1.5);
-            }
-            m_paddleSizeTimer = DURATION;
-            m_activePowerUpText = "Bigger Paddle!";
-            m_powerUpTextTimer = 2.0;
-            break;
-            
-        case PowerUpType::SmallerPaddle:
-            if (m_paddleSizeTimer <= 0.0) {
-                m_paddle->setWidth(m_paddle->width() * 0.6);
-            }
-            m_paddleSizeTimer = DURATION;
-            m_activePowerUpText = "Smaller Paddle!";
-            m_powerUpTextTimer = 2.0;
-            break;
-            
-        case PowerUpType::SlowBall:
-            if (m_ballSpeedTimer <= 0.0) {
-                QPointF vel = m_ball->velocity();
-                m_ball->setVelocity(vel.x() * 0.7, vel.y() * 0.7);
-            }
-            m_ballSpeedTimer = DURATION;
-            m_activePowerUpText = "Slow Ball!";
-            m_powerUpTextTimer = 2.0;
-            break;
-            
-        case PowerUpType::FastBall:
-            if (m_ballSpeedTimer <= 0.0) {
-                QPointF vel = m_ball->velocity();
-                m_ball->setVelocity(vel.x() * 1.5, vel.y() * 1.5);
-            }
-            m_ballSpeedTimer = DURATION;
-            m_activePowerUpText = "Fast Ball!";
-            m_powerUpTextTimer = 2.0;
-            break;
-            
-        case PowerUpType::ExtraLife:
-            m_lives++;
-            m_activePowerUpText = "Extra Life!";
-            m_powerUpTextTimer = 2.0;
-            break;
+        m_countdownText.drawCentered(painter, textRect);
     }
 }
 
 void GameScene::drawPowerUps(QPainter &painter)
 {
+    ScopedTimer timer("drawPowerUps");
+    
     painter.setRenderHint(QPainter::Antialiasing);
     
-    for (const auto &powerUp : m_powerUps) {
-        if (!powerUp->isActive()) continue;
-        
-        QRectF powerUpRect = powerUp->rect();
+    const auto &powerUps = m_frame->powerUps;
+    for (size_t i = 0; i < powerUps.size(); ++i) {
+        QRectF powerUpRect = m_frame->powerUpAt(static_cast<int>(i), m_renderAlpha);
         QPoint screenPos = gameToScreen(powerUpRect.topLeft());
         QPoint screenBottomRight = gameToScreen(powerUpRect.bottomRight());
         QRectF screenRect(screenPos, screenBottomRight);
         
         QLinearGradient gradient(screenRect.topLeft(), screenRect.bottomLeft());
-        QColor color = powerUp->color();
+        QColor color = powerUps[i].color;
         gradient.setColorAt(0, color.lighter(130));
         gradient.setColorAt(1, color);
         
@@ -766,35 +879,35 @@ void GameScene::drawPowerUps(QPainter &painter)
         painter.drawRoundedRect(screenRect, 4, 4);
         
         painter.setPen(Qt::white);
-        painter.setFont(QFont("Arial", 8, QFont::Bold));
-        painter.drawText(screenRect, Qt::AlignCenter, powerUp->name().at(0));
+        m_powerUpLetters[static_cast<int>(powerUps[i].type)].drawCentered(painter, screenRect);
     }
 }
 
 void GameScene::drawActivePowerUps(QPainter &painter)
 {
+    ScopedTimer timer("drawActivePowerUps");
+    
     if (m_powerUpTextTimer > 0.0) {
         painter.setPen(QColor(255, 255, 100));
-        painter.setFont(QFont("Arial", 20, QFont::Bold));
         
         QRect textRect = rect();
         textRect.setTop(height() / 2 - 50);
         textRect.setHeight(50);
         
-        painter.drawText(textRect, Qt::AlignCenter, m_activePowerUpText);
+        m_powerUpBannerText.drawCentered(painter, textRect);
     }
 }
 
 void GameScene::drawParticles(QPainter &painter)
 {
+    ScopedTimer timer("drawParticles");
+    
     painter.setRenderHint(QPainter::Antialiasing);
     
-    for (const auto &particle : m_particles) {
-        if (!particle.isAlive()) continue;
-        
-        QPoint screenPos = gameToScreen(particle.position());
-        qreal size = particle.size();
-        QColor color = particle.color();
+    for (const FrameSnapshot::ParticleSprite &particle : m_frame->particles) {
+        QPoint screenPos = gameToScreen(particle.position);
+        qreal size = particle.size;
+        QColor color = QColor::fromRgba(particle.color);
         
         painter.setBrush(color);
         painter.setPen(Qt::NoPen);
@@ -804,34 +917,28 @@ void GameScene::drawParticles(QPainter &painter)
 
 void GameScene::drawBallTrail(QPainter &painter)
 {
-    if (m_ballTrail.size() < 2) return;
+    ScopedTimer timer("drawBallTrail");
     
-    painter.setRenderHint(QPainter::Antialiasing);
+    const int count = m_ballTrail.size();
+    if (count < 2) return;
+    
+    // Batch every dot into a single fragment draw; the vector keeps its
+    // capacity between frames
+    const QRectF source = m_trailSprite.rect();
+    m_trailFragments.clear();
     
-    for (size_t i = 0; i < m_ballTrail.size(); ++i) {
-        qreal alpha = static_cast<qreal>(i) / m_ballTrail.size();
-        qreal radius = m_ball->radius() * alpha * 0.5;
-        
-        QPoint screenPos = gameToScreen(m_ballTrail[i]);
-        
-        QColor trailColor(150, 200, 255, static_cast<int>(alpha * 100));
-        painter.setBrush(trailColor);
-        painter.setPen(Qt::NoPen);
-        painter.drawEllipse(screenPos, static_cast<int>(radius), static_cast<int>(radius));
-    }
-}
-
-void GameScene::spawnParticles(qreal x, qreal y, const QColor &color, int count)
-{
     for (int i = 0; i < count; ++i) {
-        qreal angle = (std::rand() % 360) * M_PI / 180.0;
-        qreal speed = 100.0 + (std::rand() % 200);
-        qreal vx = std::cos(angle) * speed;
-        qreal vy = std::sin(angle) * speed - 100.0;
-        qreal lifetime = 0.5 + (std::rand() % 100) / 100.0;
+        qreal alpha = static_cast<qreal>(i) / count;
+        qreal radius = GameWorld::BALL_RADIUS * alpha * 0.5;
+        qreal scale = radius / TRAIL_SPRITE_RADIUS;
         
-        m_particles.emplace_back(x, y, vx, vy, color, lifetime);
+        QPointF screenPos = gameToScreen(m_ballTrail.at(i));
+        m_trailFragments.push_back(QPainter::PixmapFragment::create(
+            screenPos, source, scale, scale, 0.0, alpha * 100.0 / 255.0));
     }
+    
+    painter.drawPixmapFragments(m_trailFragments.data(),
+                                static_cast<int>(m_trailFragments.size()), m_trailSprite);
 }
 
 void GameScene::updateScreenShake(qreal delta)
@@ -840,7 +947,7 @@ void GameScene::updateScreenShake(qreal delta)
         m_screenShakeDuration -= delta;
         
         if (m_screenShakeDuration > 0.0) {
-            qreal angle = (std::rand() % 360) * M_PI / 180.0;
+            qreal angle = m_shakeRandom.uniform(0.0, 2.0 * M_PI);
             m_screenShakeOffset.setX(std::cos(angle) * m_screenShakeAmount);
             m_screenShakeOffset.setY(std::sin(angle) * m_screenShakeAmount);
         } else {
@@ -850,6 +957,171 @@ void GameScene::updateScreenShake(qreal delta)
     }
 }
 
+void GameScene::setParticleBudget(int budget)
+{
+    WorldCommand command;
+    command.type = WorldCommand::Type::SetParticleBudget;
+    command.particleBudget = budget;
+    m_simulation->post(command);
+}
+
+void GameScene::setAutopilot(bool enabled)
+{
+    WorldCommand command;
+    command.type = WorldCommand::Type::SetAutopilot;
+    command.autopilot = enabled;
+    if (!m_simulation->post(command)) {
+        return;
+    }
+    m_autopilot = enabled;
+    
+    // The worker leaves a still paddle behind; resend any keys held now
+    if (!enabled) {
+        m_sentInput = PaddleInput();
+        sendInput();
+    }
+}
+
+bool GameScene::startCapture(const QString &directory, FrameCapture::Format format, int frameLimit)
+{
+    m_capture.setFrameLimit(frameLimit);
+    return m_capture.start(directory, format);
+}
+
+void GameScene::stopCapture()
+{
+    m_capture.stop();
+    m_captureImages[0] = QImage();
+    m_captureImages[1] = QImage();
+}
+
+void GameScene::captureFrame()
+{
+    ScopedTimer timer("Capture");
+    
+    // Encoders behind: skip the render, not just the submit
+    if (!m_capture.canAccept()) {
+        m_capture.dropFrame();
+        return;
+    }
+    
+    // A whole frame every time, independent of what the widget repaints;
+    // the image matches the widget's pixels. Two images take turns so one
+    // can be encoded while the other is painted; one still held by a queued
+    // encode is replaced, since painting into it would copy it anyway.
+    const qreal dpr = devicePixelRatioF();
+    const QSize pixels = size() * dpr;
+    QImage &image = m_captureImages[m_nextCaptureImage];
+    m_nextCaptureImage ^= 1;
+    if (image.size() != pixels || !image.isDetached()) {
+        image = QImage(pixels, QImage::Format_RGB32);
+    }
+    image.setDevicePixelRatio(dpr);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    renderScene(painter);
+    painter.end();
+    
+    m_capture.submit(image, m_frame->tick, m_simulation->now());
+    if (m_capture.isFull()) {
+        stopCapture();
+        emit captureFinished();
+    }
+}
+
+void GameScene::setProfilerVisible(bool visible)
+{
+    m_showProfiler = visible;
+    if (visible) {
+        refreshProfilerStats();
+    }
+    m_fullRepaint = true;
+}
+
+void GameScene::refreshProfilerStats()
+{
+    Profiler &profiler = Profiler::instance();
+    m_profilerFrameStats = profiler.frameStats();
+    m_profilerRefresh.restart();
+    
+    const Profiler::FrameStats &frames = m_profilerFrameStats;
+    m_profilerLines.clear();
+    m_profilerLines << QString::asprintf("Frame p50 %5.2f  p95 %5.2f  p99 %5.2f ms",
+                                         frames.p50, frames.p95, frames.p99);
+    m_profilerLines << QString::asprintf("Worst %.2f ms over %d frames", frames.worst, frames.samples);
+    
+    // Busiest sections over the last second
+    const auto sections = profiler.sectionStats(1000000000);
+    for (size_t i = 0; i < sections.size() && i < 10; ++i) {
+        const Profiler::SectionStats &section = sections[i];
+        m_profilerLines << QString::asprintf("%-20s %6.3f ms x%-4d", qPrintable(section.name),
+                                             section.meanMs, section.calls);
+    }
+}
+
+QRect GameScene::profilerRect() const
+{
+    return QRect(width() - 330, 55, 320, 290);
+}
+
+void GameScene::drawProfilerOverlay(QPainter &painter)
+{
+    const QRect area = profilerRect();
+    painter.fillRect(area, QColor(0, 0, 0, 180));
+    painter.setFont(m_profilerFont);
+    painter.setPen(QColor(200, 255, 200));
+    
+    const int left = area.left() + 8;
+    int y = area.top() + 16;
+    for (int i = 0; i < 2 && i < m_profilerLines.size(); ++i) {
+        painter.drawText(left, y, m_profilerLines[i]);
+        y += 15;
+    }
+    
+    // Frame time histogram; bars past a 60 Hz frame budget turn red
+    const std::vector<int> &histogram = m_profilerFrameStats.histogram;
+    const int peak = histogram.empty() ? 0 : *std::max_element(histogram.begin(), histogram.end());
+    const QRect bars(left, y, area.width() - 16, 60);
+    if (peak > 0) {
+        const qreal barWidth = bars.width() / static_cast<qreal>(histogram.size());
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            const qreal barHeight = bars.height() * histogram[i] / static_cast<qreal>(peak);
+            const bool overBudget = i * Profiler::HISTOGRAM_BUCKET_MS >= 1000.0 / 60.0;
+            painter.fillRect(QRectF(bars.left() + i * barWidth, bars.bottom() - barHeight,
+                                    barWidth - 1, barHeight),
+                             overBudget ? QColor(255, 100, 100) : QColor(100, 220, 120));
+        }
+    }
+    painter.setPen(QColor(120, 120, 120));
+    painter.drawLine(bars.bottomLeft(), bars.bottomRight());
+    y = bars.bottom() + 18;
+    
+    painter.setPen(QColor(200, 255, 200));
+    for (int i = 2; i < m_profilerLines.size(); ++i) {
+        painter.drawText(left, y, m_profilerLines[i]);
+        y += 15;
+    }
+}
+
+void GameScene::setFrameRateCap(int framesPerSecond, bool vsync)
+{
+    // With vsync, never render faster than the display refreshes
+    int rate = framesPerSecond;
+    if (vsync && screen()) {
+        const int refreshRate = qRound(screen()->refreshRate());
+        rate = rate > 0 ? std::min(rate, refreshRate) : refreshRate;
+    }
+    
+    // The simulation runs on its own fixed tick, so this only paces rendering
+    m_gameTimer.start(rate > 0 ? qRound(1000.0 / rate) : 0);
+}
+
+void GameScene::setTrailLength(int length)
+{
+    m_ballTrail.setLength(length);
+    m_trailFragments.reserve(m_ballTrail.length());
+}
+
 void GameScene::setHighScoreManager(HighScoreManager *manager)
 {
     m_highScoreManager = manager;
@@ -866,23 +1138,42 @@ void GameScene::applySoundSettings(bool soundEnabled, bool musicEnabled,
     }
 }
 
+void GameScene::scheduleHighScoreCheck()
+{
+    // The name prompt is modal; open it from the event loop rather than
+    // from inside the event processing of a frame
+    if (m_highScoreCheckPending) {
+        return;
+    }
+    m_highScoreCheckPending = true;
+    QTimer::singleShot(0, this, &GameScene::checkForHighScore);
+}
+
 void GameScene::checkForHighScore()
 {
+    m_highScoreCheckPending = false;
     if (!m_highScoreManager) return;
     
-    if (m_highScoreManager->isHighScore(m_score)) {
+    const int score = m_frame->score;
+    if (m_highScoreManager->isHighScore(score)) {
+        // The dialog's event loop would otherwise keep running gameLoop()
+        m_gameTimer.stop();
+        
         bool ok;
         QString name = QInputDialog::getText(
             this,
             "High Score!",
-            QString("Congratulations! You achieved a high score of %1!\nEnter your name:").arg(m_score),
+            QString("Congratulations! You achieved a high score of %1!\nEnter your name:").arg(score),
             QLineEdit::Normal,
             "Player",
             &ok
         );
         
+        m_elapsedTimer.restart();
+        m_gameTimer.start();
+        
         if (ok && !name.isEmpty()) {
-            m_highScoreManager->addHighScore(name, m_score);
+            m_highScoreManager->addHighScore(name, score);
         }
     }
 }
@@ -898,19 +1189,105 @@ void GameScene::loadCurrentLevel()
         return;
     }
     
-    const Level *level = m_levelManager->getCurrentLevel();
+    // Take the prefetched level if it is the one wanted. The prefetch was
+    // started seconds ago, so waiting for it is normally a no-op.
+    std::shared_ptr<const Level> level;
+    std::shared_ptr<LevelLayout> layout;
+    m_preparedBrickLayer = QImage();
+    if (m_prefetch.isValid()) {
+        const PreparedLevel prepared = m_prefetch.result();
+        m_prefetch = QFuture<PreparedLevel>();
+        if (prepared.id == m_levelManager->currentLevelNumber() && prepared.level) {
+            level = prepared.level;
+            layout = prepared.layout;
+            m_preparedBrickLayer = prepared.brickLayer;
+        }
+    }
+    
+    if (!level) {
+        level = m_levelManager->getCurrentLevel();
+    }
     if (!level) {
         return;
     }
     
-    if (m_ball && level->ballSpeed() > 0.0) {
-        m_ball->setSpeed(level->ballSpeed());
+    WorldCommand command;
+    command.type = WorldCommand::Type::LoadLevel;
+    command.levelId = m_levelManager->currentLevelNumber();
+    command.level = level;
+    command.layout = layout;
+    m_simulation->post(command);
+    
+    m_levelComplete = false;
+    m_levelTransitionTimer = 0.0;
+    m_fullRepaint = true;
+}
+
+bool GameScene::saveReplay(const QString &filePath)
+{
+    // The recording lives on the simulation thread; fetching a copy takes a
+    // single queued call
+    Replay replay;
+    SimulationWorker *simulation = m_simulation;
+    QMetaObject::invokeMethod(simulation, [simulation, &replay] {
+        replay = simulation->recordedReplay();
+    }, Qt::BlockingQueuedConnection);
+    
+    if (!replay.isValid()) {
+        qWarning() << "No game has been recorded yet";
+        return false;
+    }
+    return replay.save(filePath);
+}
+
+bool GameScene::playReplay(const QString &filePath, int speed)
+{
+    auto replay = std::make_shared<Replay>();
+    if (!replay->load(filePath)) {
+        return false;
+    }
+    if (replay->tickRate() != GameWorld::DEFAULT_TICK_RATE) {
+        qWarning() << "Replay was recorded at" << replay->tickRate() << "ticks per second";
+        return false;
     }
     
-    createBricks();
+    // Fetch every level the replay loads up front, so the simulation thread
+    // never touches the level manager
+    std::map<int, std::shared_ptr<const Level>> levels;
+    for (int id : replay->levelIds()) {
+        std::shared_ptr<const Level> level = m_levelManager ? m_levelManager->level(id) : nullptr;
+        if (!level) {
+            qWarning() << "Replay needs level" << id << "which is not available";
+            return false;
+        }
+        levels[id] = level;
+    }
+    
+    WorldCommand command;
+    command.type = WorldCommand::Type::PlayReplay;
+    command.playbackSpeed = speed;
+    command.replay = std::make_shared<ReplayPlayer>(replay, [levels](int id) -> std::shared_ptr<const Level> {
+        auto it = levels.find(id);
+        return it != levels.end() ? it->second : nullptr;
+    });
     
+    m_paused = false;
+    m_fullRepaint = true;
+    m_gameState = GameState::Playing;
+    m_powerUpTextTimer = 0.0;
     m_levelComplete = false;
     m_levelTransitionTimer = 0.0;
+    m_replaying = true;
+    m_replaySpeed = speed;
+    
+    postCommand(WorldCommand::Type::SetPaused);
+    m_simulation->post(command);
+    
+    m_ballTrail.clear();
+    m_screenShakeAmount = 0.0;
+    m_screenShakeDuration = 0.0;
+    m_screenShakeOffset = QPointF(0, 0);
+    return true;
 }
 
 void GameScene::completeLevel()
@@ -921,28 +1298,57 @@ void GameScene::completeLevel()
     
     m_levelComplete = true;
     m_levelTransitionTimer = 3.0; // 3 seconds transition
+    m_fullRepaint = true;
     
     // Unlock next level
     int nextLevelNum = m_levelManager->currentLevelNumber() + 1;
     m_levelManager->unlockLevel(nextLevelNum);
     m_levelManager->saveProgress();
+    
+    prefetchNextLevel();
+}
+
+void GameScene::prefetchNextLevel()
+{
+    if (!m_levelManager->hasNextLevel() || m_prefetch.isRunning()) {
+        return;
+    }
+    
+    const LevelManager *levels = m_levelManager;
+    const int id = m_levelManager->currentLevelNumber() + 1;
+    const QSize sceneSize = size();
+    const qreal dpr = devicePixelRatioF();
+    const QFont font = m_brickFont;
+    m_prefetch = QtConcurrent::run([levels, id, sceneSize, dpr, font] {
+        PreparedLevel prepared;
+        prepared.id = id;
+        prepared.level = levels->level(id);
+        if (prepared.level) {
+            prepared.layout = std::make_shared<LevelLayout>(GameWorld::buildLayout(*prepared.level));
+            prepared.brickLayer = renderBrickLayer(prepared.layout->bricks, sceneSize, dpr, font);
+        }
+        return prepared;
+    });
 }
 
 void GameScene::drawLevelInfo(QPainter &painter)
 {
+    ScopedTimer timer("drawLevelInfo");
+    
     if (!m_levelManager) {
         return;
     }
     
-    const Level *level = m_levelManager->getCurrentLevel();
+    std::shared_ptr<const Level> level = m_levelManager->getCurrentLevel();
     if (!level) {
         return;
     }
     
-    painter.setPen(Qt::white);
-    painter.setFont(QFont("Arial", 12));
+    m_levelInfoText.update(level->levelNumber(), [&] {
+        return QString("Level %1: %2").arg(level->levelNumber()).arg(level->name());
+    });
     
-    QString levelText = QString("Level %1: %2").arg(level->levelNumber()).arg(level->name());
-    painter.drawText(10, 25, levelText);
+    painter.setPen(Qt::white);
+    m_levelInfoText.draw(painter, 10, 25);
 }
 
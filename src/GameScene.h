@@ -2,21 +2,33 @@
 #define GAMESCENE_H
 
 #include <QWidget>
+#include <QPainter>
+#include <QPixmap>
+#include <QImage>
+#include <QFont>
+#include <QRegion>
 #include <QPointF>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QFuture>
+#include <QThread>
 #include <QSet>
+#include <QStringList>
 #include <vector>
+#include <array>
 #include <memory>
-#include "Paddle.h"
-#include "Ball.h"
-#include "Brick.h"
-#include "PowerUp.h"
+#include "GameWorld.h"
 #include "SoundManager.h"
-#include "Particle.h"
+#include "SimulationWorker.h"
+#include "BallTrail.h"
+#include "CachedText.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "FrameCapture.h"
 
 class HighScoreManager;
 class LevelManager;
+class Level;
 
 enum class GameState {
     Menu,
@@ -32,7 +44,8 @@ class GameScene : public QWidget
 
 public:
     explicit GameScene(QWidget *parent = nullptr);
-
+    ~GameScene() override;
+    
     QPointF screenToGame(const QPoint &screenPos) const;
     QPoint gameToScreen(const QPointF &gamePos) const;
     
@@ -43,11 +56,37 @@ public:
     void resetGame();
     GameState gameState() const { return m_gameState; }
     
+    // The game in progress is always being recorded. Playback runs at speed
+    // times real time until the recording ends or a new game is started.
+    bool saveReplay(const QString &filePath);
+    bool playReplay(const QString &filePath, int speed);
+    bool isReplaying() const { return m_replaying; }
+    
+    // Hands the paddle to Autopilot on the simulation thread; its moves are
+    // recorded like the player's
+    void setAutopilot(bool enabled);
+    bool isAutopilot() const { return m_autopilot; }
+    
     void setHighScoreManager(HighScoreManager *manager);
     void setLevelManager(LevelManager *manager);
     void loadCurrentLevel();
     void applySoundSettings(bool soundEnabled, bool musicEnabled, 
                            float soundVolume, float musicVolume);
+    void setParticleBudget(int budget);
+    void setTrailLength(int length);
+    void setFrameRateCap(int framesPerSecond, bool vsync);  // 0 = uncapped
+    void setProfilerVisible(bool visible);
+    bool isProfilerVisible() const { return m_showProfiler; }
+    
+    // Renders every game loop frame into an image as well and writes it out
+    // on encoder threads; see FrameCapture. With a frame limit, capture
+    // stops by itself and emits captureFinished().
+    bool startCapture(const QString &directory, FrameCapture::Format format, int frameLimit = 0);
+    void stopCapture();
+    bool isCapturing() const { return m_capture.isActive(); }
+
+signals:
+    void captureFinished();
 
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -58,11 +97,22 @@ private slots:
     void gameLoop();
 
 private:
+    void renderScene(QPainter &painter);
+    void captureFrame();
     void drawBackground(QPainter &painter);
     void drawPaddle(QPainter &painter);
     void drawBall(QPainter &painter);
     void drawBricks(QPainter &painter);
-    void drawScore(QPainter &painter);
+    void updateBrickLayer();
+    void paintBrick(QPainter &painter, int index) const;
+    void markBrickDirty(int index);
+    QRectF brickScreenRect(int index) const;
+    
+    // Widget-free versions, safe to call from a worker thread
+    static QImage renderBrickLayer(const BrickField &bricks, const QSize &sceneSize, qreal dpr, const QFont &font);
+    static void paintBrick(QPainter &painter, const BrickField &bricks, int index, const QSize &sceneSize,
+                           const QFont &font);
+    static QRectF brickScreenRect(const BrickField &bricks, int index, const QSize &sceneSize);
     void drawFPS(QPainter &painter);
     void drawPauseOverlay(QPainter &painter);
     void drawGameOverOverlay(QPainter &painter);
@@ -73,67 +123,152 @@ private:
     void drawActivePowerUps(QPainter &painter);
     void drawParticles(QPainter &painter);
     void drawBallTrail(QPainter &painter);
+    void drawProfilerOverlay(QPainter &painter);
+    void refreshProfilerStats();
+    QRect profilerRect() const;
     
     void updateGame(qreal delta);
-    void checkBallPaddleCollision();
-    void checkBallBrickCollisions();
-    void checkPowerUpCollisions();
-    void checkGameState();
-    void createBricks();
-    void resetBall();
-    void loseLife();
-    void applyPowerUp(PowerUpType type);
-    void spawnPowerUp(qreal x, qreal y);
-    void spawnParticles(qreal x, qreal y, const QColor &color, int count);
+    void receiveFrame();
+    void sendInput();
+    void postCommand(WorldCommand::Type type);
+    void postNewGame();
+    void scheduleRepaint();
+    QRegion dynamicRegion() const;
+    QRegion hudDamage();
+    QRect damageRect(const QRectF &gameRect, int margin) const;
+    PaddleInput currentInput() const;
+    void processWorldEvents();
     void updateScreenShake(qreal delta);
+    void scheduleHighScoreCheck();
     void checkForHighScore();
     void completeLevel();
+    void prefetchNextLevel();
     void drawLevelInfo(QPainter &painter);
 
 private:
-    static constexpr qreal GAME_WIDTH = 800.0;
-    static constexpr qreal GAME_HEIGHT = 600.0;
-    static constexpr int TARGET_FPS = 60;
-    static constexpr qreal FRAME_TIME = 1000.0 / TARGET_FPS;
-    static constexpr int STARTING_LIVES = 3;
-    static constexpr qreal INVULNERABILITY_TIME = 2.0;
-    
-    std::unique_ptr<Paddle> m_paddle;
-    std::unique_ptr<Ball> m_ball;
-    std::vector<std::unique_ptr<Brick>> m_bricks;
-    std::vector<std::unique_ptr<PowerUp>> m_powerUps;
+    static constexpr qreal GAME_WIDTH = GameWorld::WIDTH;
+    static constexpr qreal GAME_HEIGHT = GameWorld::HEIGHT;
+    static constexpr int DEFAULT_FRAME_RATE_CAP = 60;
+    static constexpr int TRAIL_SPRITE_RADIUS = 16;
+    
+    // The simulation runs on its own thread; the scene only draws the latest
+    // frame it published, interpolated by m_renderAlpha of a tick
+    QThread m_simulationThread;
+    SimulationWorker *m_simulation;
+    const FrameSnapshot *m_frame;
+    qreal m_renderAlpha;
+    quint64 m_trailTick;
+    PaddleInput m_sentInput;
+    std::vector<GameEvent> m_worldEvents;
     std::unique_ptr<SoundManager> m_soundManager;
-    std::vector<Particle> m_particles;
-    std::vector<QPointF> m_ballTrail;
+    BallTrail m_ballTrail;
+    QPixmap m_trailSprite;
+    std::vector<QPainter::PixmapFragment> m_trailFragments;
     HighScoreManager *m_highScoreManager;
     LevelManager *m_levelManager;
+    bool m_highScoreCheckPending;
     
     QTimer m_gameTimer;
     QElapsedTimer m_elapsedTimer;
     QElapsedTimer m_fpsTimer;
     QSet<int> m_pressedKeys;
     
-    int m_score;
     bool m_paused;
     int m_frameCount;
     qreal m_fps;
     GameState m_gameState;
-    int m_lives;
     int m_level;
-    bool m_invulnerable;
-    qreal m_invulnerabilityTimer;
     
-    qreal m_paddleSizeTimer;
-    qreal m_ballSpeedTimer;
     QString m_activePowerUpText;
     qreal m_powerUpTextTimer;
     
     qreal m_screenShakeAmount;
     qreal m_screenShakeDuration;
     QPointF m_screenShakeOffset;
+    Random m_shakeRandom;
     
     bool m_levelComplete;
     qreal m_levelTransitionTimer;
+    
+    // The next level is parsed, laid out and its brick layer painted on a
+    // worker thread while the transition screen is up, so switching to it
+    // is a pointer hand-off and a layer swap
+    struct PreparedLevel
+    {
+        int id = 0;
+        std::shared_ptr<const Level> level;
+        std::shared_ptr<LevelLayout> layout;
+        QImage brickLayer;
+    };
+    QFuture<PreparedLevel> m_prefetch;
+    QImage m_preparedBrickLayer;  // Used by the first frame of the prefetched level
+    
+    bool m_replaying;
+    int m_replaySpeed;
+    bool m_autopilot;
+    FrameCapture m_capture;
+    QImage m_captureImages[2];  // Painted alternately; see captureFrame()
+    int m_nextCaptureImage;
+    
+    // Bricks are pre-rendered here and only the rects of bricks that were
+    // hit get repainted; the whole layer is rebuilt on resize or new level
+    QImage m_brickLayer;
+    quint32 m_brickLayerId;
+    bool m_brickLayerValid;
+    std::vector<int> m_dirtyBricks;
+    QFont m_brickFont;
+    
+    // Damage tracking: only the areas covered by moving objects (this frame
+    // and last) and HUD text that changed are repainted
+    struct HudState
+    {
+        int score = -1;
+        int lives = -1;
+        int level = -1;
+        int bricks = -1;
+        int fpsTenths = -1;
+        int countdownTenths = -1;
+        QString powerUpText;  // Empty while no banner is shown
+        bool replaying = false;
+        bool autopilot = false;
+    };
+    
+    QRegion m_dynamicRegion;
+    QRegion m_pendingDamage;
+    HudState m_hudState;
+    bool m_sceneAdvanced;
+    bool m_fullRepaint;
+    bool m_wasShaking;
+    
+    // HUD and overlay text, re-laid-out only when the value shown changes
+    CachedText m_scoreText;
+    CachedText m_levelText;
+    CachedText m_livesText;
+    CachedText m_bricksText;
+    CachedText m_fpsText;
+    CachedText m_levelInfoText;
+    CachedText m_powerUpBannerText;
+    std::array<CachedText, PowerUp::TYPE_COUNT> m_powerUpLetters;
+    CachedText m_pauseTitle;
+    CachedText m_pauseHint;
+    CachedText m_gameOverTitle;
+    CachedText m_finalScoreText;
+    CachedText m_restartHint;
+    CachedText m_victoryTitle;
+    CachedText m_victoryScoreText;
+    CachedText m_playAgainHint;
+    CachedText m_levelCompleteTitle;
+    CachedText m_nextLevelText;
+    CachedText m_countdownText;
+    CachedText m_replayText;
+    CachedText m_autopilotText;
+    
+    // Profiler overlay; stats are refreshed a few times a second, not per frame
+    bool m_showProfiler;
+    QElapsedTimer m_profilerRefresh;
+    Profiler::FrameStats m_profilerFrameStats;
+    QStringList m_profilerLines;
+    QFont m_profilerFont;
 };
 
 #endif
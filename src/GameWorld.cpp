@@ -0,0 +1,528 @@
+#include "GameWorld.h"
+#include "Level.h"
+#include "Profiler.h"
+#include <cmath>
+#include <cstring>
+
+GameWorld::GameWorld(int tickRate)
+    : m_state(WorldState::Playing), m_tickTime(1.0 / qMax(1, tickRate)), m_tick(0), m_brickLayoutId(0),
+      m_score(0), m_lives(STARTING_LIVES), m_levelBallSpeed(DEFAULT_BALL_SPEED), m_invulnerable(false), m_invulnerabilityTimer(0.0),
+      m_paddleSizeTimer(0.0), m_ballSpeedTimer(0.0)
+{
+    m_paddle = std::make_unique<Paddle>(350.0, 550.0, 100.0, 15.0);
+    resetBall();
+}
+
+void GameWorld::newGame(quint32 seed)
+{
+    m_dropRandom.setSeed(seed);
+    m_levelBallSpeed = DEFAULT_BALL_SPEED;
+    m_score = 0;
+    m_lives = STARTING_LIVES;
+    m_tick = 0;
+    m_bricks.clear();
+    m_brickGrid.clear();
+    ++m_brickLayoutId;
+    resetRound();
+}
+
+void GameWorld::loadLevel(const Level &level)
+{
+    loadLayout(buildLayout(level));
+}
+
+void GameWorld::loadLayout(LevelLayout &&layout)
+{
+    if (layout.ballSpeed > 0.0) {
+        m_levelBallSpeed = layout.ballSpeed;
+    }
+    
+    m_bricks = std::move(layout.bricks);
+    m_brickGrid = std::move(layout.grid);
+    ++m_brickLayoutId;
+    
+    resetRound();
+}
+
+LevelLayout GameWorld::buildLayout(const Level &level)
+{
+    LevelLayout layout;
+    layout.ballSpeed = level.ballSpeed();
+    layout.bricks.reserve(level.totalBricks());
+    
+    const qreal offsetX = (WIDTH - (BRICK_COLUMNS * (BRICK_WIDTH + BRICK_PADDING) - BRICK_PADDING)) / 2.0;
+    
+    for (const auto &brickData : level.bricks()) {
+        qreal x = offsetX + brickData.col * (BRICK_WIDTH + BRICK_PADDING);
+        qreal y = BRICK_OFFSET_Y + brickData.row * (BRICK_HEIGHT + BRICK_PADDING);
+        layout.bricks.add(x, y, BRICK_WIDTH, BRICK_HEIGHT, brickData.color, brickData.hitPoints);
+    }
+    
+    std::vector<QRectF> brickRects;
+    brickRects.reserve(layout.bricks.size());
+    for (int i = 0; i < layout.bricks.size(); ++i) {
+        brickRects.push_back(layout.bricks.rect(i));
+    }
+    layout.grid.build(brickRects, BRICK_WIDTH + BRICK_PADDING, BRICK_HEIGHT + BRICK_PADDING);
+    return layout;
+}
+
+void GameWorld::resetRound()
+{
+    // Reset per-round state but keep score, lives and bricks
+    m_state = WorldState::Playing;
+    m_invulnerable = false;
+    m_invulnerabilityTimer = 0.0;
+    m_paddleSizeTimer = 0.0;
+    m_ballSpeedTimer = 0.0;
+    
+    m_paddle->setPosition(350.0, 550.0);
+    m_paddle->setWidth(100.0);
+    resetBall();
+    
+    m_powerUps.clear();
+    m_events.clear();
+}
+
+void GameWorld::resetBall()
+{
+    m_balls.clear();
+    
+    // Set velocity at 45-degree angle (upward and to the right)
+    qreal vx = m_levelBallSpeed * 0.707;
+    qreal vy = -m_levelBallSpeed * 0.707;
+    spawnBall(400.0, 300.0, vx, vy);
+}
+
+int GameWorld::spawnBall(qreal x, qreal y, qreal vx, qreal vy)
+{
+    return m_balls.add(x, y, vx, vy, BALL_RADIUS);
+}
+
+void GameWorld::step(const PaddleInput &input)
+{
+    if (m_state != WorldState::Playing) {
+        return;
+    }
+    
+    ScopedTimer stepTimer("World step");
+    const qreal delta = m_tickTime;
+    m_tick++;
+    
+    updateTimers(delta);
+    
+    {
+        ScopedTimer timer("Input");
+        if (input.left) {
+            m_paddle->moveLeft(delta);
+        }
+        if (input.right) {
+            m_paddle->moveRight(delta);
+        }
+        m_paddle->constrainToBounds(0, WIDTH);
+    }
+    
+    moveBalls(delta);
+    
+    {
+        ScopedTimer timer("Power-ups");
+        const std::vector<int> &live = m_powerUps.live();
+        for (int i = static_cast<int>(live.size()) - 1; i >= 0; --i) {
+            PowerUp &powerUp = m_powerUps.at(live[i]);
+            powerUp.move(delta);
+            if (powerUp.rect().top() > HEIGHT) {
+                m_powerUps.despawn(live[i]);
+            }
+        }
+        
+        checkPowerUpCollisions();
+    }
+    
+    checkWorldState();
+}
+
+void GameWorld::updateTimers(qreal delta)
+{
+    if (m_invulnerable) {
+        m_invulnerabilityTimer -= delta;
+        if (m_invulnerabilityTimer <= 0.0) {
+            m_invulnerable = false;
+            m_invulnerabilityTimer = 0.0;
+        }
+    }
+    
+    if (m_paddleSizeTimer > 0.0) {
+        m_paddleSizeTimer -= delta;
+        if (m_paddleSizeTimer <= 0.0) {
+            m_paddle->setWidth(100.0);
+            m_paddleSizeTimer = 0.0;
+        }
+    }
+    
+    if (m_ballSpeedTimer > 0.0) {
+        m_ballSpeedTimer -= delta;
+        if (m_ballSpeedTimer <= 0.0) {
+            qreal normalSpeed = 300.0;
+            for (int i = 0; i < m_balls.size(); ++i) {
+                if (m_balls.speed(i) > 0.0) {
+                    m_balls.setSpeed(i, normalSpeed);
+                }
+            }
+            m_ballSpeedTimer = 0.0;
+        }
+    }
+}
+
+void GameWorld::checkWorldState()
+{
+    // Drop balls that fell out; a life is only lost with the last one
+    QPointF lostAt;
+    bool anyLost = false;
+    for (int i = m_balls.size() - 1; i >= 0; --i) {
+        if (m_balls.y(i) > HEIGHT) {
+            lostAt = m_balls.position(i);
+            anyLost = true;
+            m_balls.remove(i);
+        }
+    }
+    
+    if (anyLost && m_balls.isEmpty()) {
+        loseLife(lostAt);
+        if (m_state == WorldState::GameOver) {
+            return;
+        }
+    }
+    
+    if (m_bricks.allDestroyed()) {
+        m_state = WorldState::LevelCleared;
+        m_events.emplace_back(GameEvent::Type::LevelCleared);
+    }
+}
+
+void GameWorld::loseLife(const QPointF &position)
+{
+    m_lives--;
+    m_events.emplace_back(GameEvent::Type::LifeLost, position);
+    
+    if (m_lives <= 0) {
+        m_state = WorldState::GameOver;
+        m_events.emplace_back(GameEvent::Type::GameOver);
+    } else {
+        m_paddle->setPosition(350.0, 550.0);
+        resetBall();
+        m_invulnerable = true;
+        m_invulnerabilityTimer = INVULNERABILITY_TIME;
+    }
+}
+
+void GameWorld::moveBalls(qreal delta)
+{
+    {
+        // Broad phase: only balls whose path this tick may reach the bricks or
+        // the paddle need the swept solver, everything else is integrated in bulk
+        ScopedTimer timer("Brick collision");
+        m_sweptBalls.assign(m_balls.size(), 0);
+        m_balls.markPathsTouching(m_brickGrid.bounds(), delta, m_sweptBalls);
+        if (!m_invulnerable) {
+            m_balls.markPathsTouching(m_paddle->rect(), delta, m_sweptBalls);
+        }
+        
+        for (int i = 0; i < m_balls.size(); ++i) {
+            if (m_sweptBalls[i]) {
+                sweepBall(i, delta);
+            }
+        }
+    }
+    
+    ScopedTimer timer("Ball move");
+    m_balls.move(delta, m_sweptBalls);
+    m_balls.checkBoundaryCollision(0, WIDTH, 0);
+}
+
+void GameWorld::sweepBall(int ball, qreal delta)
+{
+    // Walls are thick slabs around the playfield; the bottom stays open
+    static const QRectF walls[] = {
+        QRectF(-1000.0, -1000.0, 1000.0, HEIGHT + 2000.0),
+        QRectF(WIDTH, -1000.0, 1000.0, HEIGHT + 2000.0),
+        QRectF(-1000.0, -1000.0, WIDTH + 2000.0, 1000.0)
+    };
+    
+    // Sweep the ball along its path, resolving contacts in time order so
+    // fast balls and long ticks cannot tunnel through bricks or the paddle
+    const qreal radius = m_balls.radius(ball);
+    qreal remaining = delta;
+    for (int contact = 0; contact < MAX_CONTACTS_PER_TICK && remaining > 0.0; ++contact) {
+        const QPointF start = m_balls.position(ball);
+        const QPointF motion = m_balls.velocity(ball) * remaining;
+        
+        enum class Contact { None, Wall, Paddle, Brick };
+        Contact kind = Contact::None;
+        SweepHit nearest;
+        int brick = -1;
+        
+        for (const QRectF &wall : walls) {
+            SweepHit hit;
+            if (sweepCircleRect(start, motion, radius, wall, hit) && hit.time < nearest.time) {
+                nearest = hit;
+                kind = Contact::Wall;
+            }
+        }
+        
+        SweepHit hit;
+        if (!m_invulnerable && sweepCircleRect(start, motion, radius, m_paddle->rect(), hit) &&
+            hit.time < nearest.time) {
+            nearest = hit;
+            kind = Contact::Paddle;
+        }
+        
+        if (findBrickContact(start, motion, radius, brick, hit) && hit.time <= nearest.time) {
+            nearest = hit;
+            kind = Contact::Brick;
+        }
+        
+        if (kind == Contact::None) {
+            m_balls.moveOne(ball, remaining);
+            break;
+        }
+        
+        m_balls.moveOne(ball, remaining * nearest.time);
+        remaining -= remaining * nearest.time;
+        
+        switch (kind) {
+            case Contact::Wall: {
+                QPointF vel = m_balls.velocity(ball);
+                qreal along = vel.x() * nearest.normal.x() + vel.y() * nearest.normal.y();
+                m_balls.setVelocity(ball, vel.x() - 2.0 * along * nearest.normal.x(),
+                                    vel.y() - 2.0 * along * nearest.normal.y());
+                break;
+            }
+            case Contact::Paddle:
+                bounceOffPaddle(ball);
+                break;
+            case Contact::Brick:
+                hitBrick(ball, brick, nearest.normal);
+                break;
+            case Contact::None:
+                break;
+        }
+    }
+}
+
+bool GameWorld::findBrickContact(const QPointF &start, const QPointF &motion, qreal radius,
+                                 int &brick, SweepHit &hit)
+{
+    const QPointF end = start + motion;
+    QRectF sweptArea(qMin(start.x(), end.x()) - radius, qMin(start.y(), end.y()) - radius,
+                     qAbs(motion.x()) + radius * 2.0, qAbs(motion.y()) + radius * 2.0);
+    
+    m_brickCandidates.clear();
+    m_brickGrid.query(sweptArea, m_brickCandidates);
+    
+    // Earliest contact wins; ties go to the lowest brick index
+    bool found = false;
+    for (int index : m_brickCandidates) {
+        if (!m_bricks.isActive(index)) continue;
+        
+        SweepHit candidate;
+        if (sweepCircleRect(start, motion, radius, m_bricks.rect(index), candidate)) {
+            if (!found || candidate.time < hit.time ||
+                (candidate.time == hit.time && index < brick)) {
+                hit = candidate;
+                brick = index;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+void GameWorld::bounceOffPaddle(int ball)
+{
+    QRectF paddleRect = m_paddle->rect();
+    QPointF ballPos = m_balls.position(ball);
+    
+    qreal hitPos = (ballPos.x() - paddleRect.left()) / paddleRect.width();
+    hitPos = qBound(0.0, hitPos, 1.0);
+    
+    qreal angle = (hitPos - 0.5) * 2.0;
+    qreal speed = m_balls.speed(ball);
+    
+    qreal newVx = angle * speed * 0.8;
+    qreal newVy = -std::abs(speed * 0.8);
+    
+    m_balls.setVelocity(ball, newVx, newVy);
+    m_events.emplace_back(GameEvent::Type::PaddleHit, ballPos);
+}
+
+void GameWorld::hitBrick(int ball, int index, const QPointF &normal)
+{
+    QRectF brickRect = m_bricks.rect(index);
+    bool destroyed = m_bricks.hit(index);
+    m_score += destroyed ? 10 : 5;  // Less points for just damaging
+    
+    if (destroyed) {
+        m_events.emplace_back(GameEvent::Type::BrickDestroyed, brickRect.center(), m_bricks.color(index));
+        m_events.back().brick = index;
+        spawnPowerUp(brickRect.center().x(), brickRect.center().y());
+    } else {
+        m_events.emplace_back(GameEvent::Type::BrickHit, brickRect.center(), m_bricks.color(index));
+        m_events.back().brick = index;
+    }
+    
+    // Reflect about the contact normal (axis-aligned on faces, radial on corners)
+    QPointF vel = m_balls.velocity(ball);
+    qreal along = vel.x() * normal.x() + vel.y() * normal.y();
+    m_balls.setVelocity(ball, vel.x() - 2.0 * along * normal.x(),
+                        vel.y() - 2.0 * along * normal.y());
+}
+
+void GameWorld::splitBalls()
+{
+    // Each ball in play splits into three, fanned out around its heading
+    const qreal spread = 0.5;
+    const qreal c = std::cos(spread);
+    const qreal s = std::sin(spread);
+    const int count = m_balls.size();
+    
+    for (int i = 0; i < count && m_balls.size() + 2 <= MULTI_BALL_LIMIT; ++i) {
+        QPointF pos = m_balls.position(i);
+        QPointF vel = m_balls.velocity(i);
+        spawnBall(pos.x(), pos.y(), vel.x() * c - vel.y() * s, vel.x() * s + vel.y() * c);
+        spawnBall(pos.x(), pos.y(), vel.x() * c + vel.y() * s, -vel.x() * s + vel.y() * c);
+    }
+}
+
+void GameWorld::spawnPowerUp(qreal x, qreal y)
+{
+    if (m_dropRandom.bounded(100) < 20) {
+        PowerUpType type = static_cast<PowerUpType>(m_dropRandom.bounded(PowerUp::TYPE_COUNT));
+        dropPowerUp(x, y, type);
+    }
+}
+
+int GameWorld::dropPowerUp(qreal x, qreal y, PowerUpType type)
+{
+    return m_powerUps.spawn(x, y, type);
+}
+
+void GameWorld::checkPowerUpCollisions()
+{
+    QRectF paddleRect = m_paddle->rect();
+    
+    const std::vector<int> &live = m_powerUps.live();
+    for (int i = static_cast<int>(live.size()) - 1; i >= 0; --i) {
+        const int slot = live[i];
+        const PowerUp &powerUp = m_powerUps.at(slot);
+        QRectF powerUpRect = powerUp.rect();
+        
+        if (paddleRect.intersects(powerUpRect)) {
+            m_events.emplace_back(GameEvent::Type::PowerUpCollected, powerUpRect.center(),
+                                  powerUp.color(), powerUp.type());
+            applyPowerUp(powerUp.type());
+            m_powerUps.despawn(slot);
+        }
+    }
+}
+
+void GameWorld::applyPowerUp(PowerUpType type)
+{
+    const qreal DURATION = 10.0;
+    
+    switch (type) {
+        case PowerUpType::BiggerPaddle:
+            if (m_paddleSizeTimer <= 0.0) {
+                m_paddle->setWidth(m_paddle->width() * 1.5);
+            }
+            m_paddleSizeTimer = DURATION;
+            break;
+        
+        case PowerUpType::SmallerPaddle:
+            if (m_paddleSizeTimer <= 0.0) {
+                m_paddle->setWidth(m_paddle->width() * 0.6);
+            }
+            m_paddleSizeTimer = DURATION;
+            break;
+        
+        case PowerUpType::SlowBall:
+            if (m_ballSpeedTimer <= 0.0) {
+                m_balls.scaleVelocities(0.7);
+            }
+            m_ballSpeedTimer = DURATION;
+            break;
+        
+        case PowerUpType::FastBall:
+            if (m_ballSpeedTimer <= 0.0) {
+                m_balls.scaleVelocities(1.5);
+            }
+            m_ballSpeedTimer = DURATION;
+            break;
+        
+        case PowerUpType::ExtraLife:
+            m_lives++;
+            break;
+            
+        case PowerUpType::MultiBall:
+            splitBalls();
+            break;
+    }
+}
+
+quint64 GameWorld::stateHash() const
+{
+    // FNV-1a over the raw bits of every value that influences later ticks
+    quint64 hash = 14695981039346656037ull;
+    auto mix = [&hash](const auto &value) {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        for (unsigned char byte : bytes) {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+    };
+    
+    mix(m_tick);
+    mix(static_cast<int>(m_state));
+    mix(m_score);
+    mix(m_lives);
+    mix(m_levelBallSpeed);
+    mix(m_invulnerable);
+    mix(m_invulnerabilityTimer);
+    mix(m_paddleSizeTimer);
+    mix(m_ballSpeedTimer);
+    
+    const QRectF paddleRect = m_paddle->rect();
+    mix(paddleRect.x());
+    mix(paddleRect.y());
+    mix(paddleRect.width());
+    
+    for (int i = 0; i < m_balls.size(); ++i) {
+        mix(m_balls.x(i));
+        mix(m_balls.y(i));
+        mix(m_balls.velocity(i).x());
+        mix(m_balls.velocity(i).y());
+    }
+    
+    for (int i = 0; i < m_bricks.size(); ++i) {
+        mix(m_bricks.isActive(i));
+        mix(m_bricks.hitPoints(i));
+    }
+    
+    // Despawned power-ups leave no trace in the pool; the drop generator's
+    // state stands in for every roll made so far
+    mix(m_dropRandom);
+    for (int slot : m_powerUps.live()) {
+        const PowerUp &powerUp = m_powerUps.at(slot);
+        mix(slot);
+        mix(static_cast<int>(powerUp.type()));
+        mix(powerUp.rect().x());
+        mix(powerUp.rect().y());
+    }
+    
+    return hash;
+}
+
+void GameWorld::takeEvents(std::vector<GameEvent> &out)
+{
+    out.clear();
+    out.swap(m_events);
+}
@@ -0,0 +1,163 @@
+#ifndef GAMEWORLD_H
+#define GAMEWORLD_H
+
+#include <QPointF>
+#include <QColor>
+#include <vector>
+#include <memory>
+#include "Paddle.h"
+#include "BallArray.h"
+#include "BrickField.h"
+#include "PowerUpPool.h"
+#include "BrickGrid.h"
+#include "Collision.h"
+#include "Random.h"
+
+class Level;
+
+// Simulation core of the game. Owns every gameplay object and advances them
+// in fixed tickTime() steps, independent of any widget or timer, so it can be
+// driven by GameScene or run headless.
+
+enum class WorldState {
+    Playing,
+    LevelCleared,
+    GameOver
+};
+
+struct PaddleInput
+{
+    bool left = false;
+    bool right = false;
+};
+
+// Things that happened during a step which a front-end may want to present
+// (sounds, particles, screen shake). The simulation never depends on them.
+struct GameEvent
+{
+    enum class Type {
+        PaddleHit,
+        BrickHit,
+        BrickDestroyed,
+        PowerUpCollected,
+        LifeLost,
+        GameOver,
+        LevelCleared
+    };
+    
+    Type type;
+    QPointF position;
+    QColor color;
+    PowerUpType powerUp;
+    int brick;  // Brick index for BrickHit/BrickDestroyed, -1 otherwise
+    
+    GameEvent(Type t = Type::PaddleHit, const QPointF &pos = QPointF(), const QColor &clr = QColor(),
+              PowerUpType pu = PowerUpType::BiggerPaddle)
+        : type(t), position(pos), color(clr), powerUp(pu), brick(-1) {}
+};
+
+// A level's bricks and broad-phase grid. Building one touches nothing but
+// the level, so it can be done ahead of time on any thread and handed to
+// GameWorld::loadLayout().
+struct LevelLayout
+{
+    qreal ballSpeed = 0.0;
+    BrickField bricks;
+    BrickGrid grid;
+};
+
+class GameWorld
+{
+public:
+    explicit GameWorld(int tickRate = DEFAULT_TICK_RATE);
+    
+    // Power-up drops are drawn from a generator seeded here, so a game is a
+    // pure function of its seed, levels and per-tick input
+    void newGame(quint32 seed);
+    void loadLevel(const Level &level);
+    void loadLayout(LevelLayout &&layout);
+    static LevelLayout buildLayout(const Level &level);
+    void resetRound();
+    void step(const PaddleInput &input);
+    int spawnBall(qreal x, qreal y, qreal vx, qreal vy);
+    int dropPowerUp(qreal x, qreal y, PowerUpType type);  // Pool slot, or -1 if the pool was full
+    
+    WorldState state() const { return m_state; }
+    quint64 tick() const { return m_tick; }
+    qreal tickTime() const { return m_tickTime; }
+    int tickRate() const { return qRound(1.0 / m_tickTime); }
+    int score() const { return m_score; }
+    int lives() const { return m_lives; }
+    qreal levelBallSpeed() const { return m_levelBallSpeed; }
+    bool isInvulnerable() const { return m_invulnerable; }
+    qreal invulnerabilityTimer() const { return m_invulnerabilityTimer; }
+    int activeBrickCount() const { return m_bricks.activeCount(); }
+    quint32 brickLayoutId() const { return m_brickLayoutId; }  // Changes whenever the brick set is replaced
+    quint64 stateHash() const;  // Fingerprint of all gameplay state, for replay verification
+    
+    const Paddle &paddle() const { return *m_paddle; }
+    const BallArray &balls() const { return m_balls; }
+    const BrickField &bricks() const { return m_bricks; }
+    const BrickGrid &brickGrid() const { return m_brickGrid; }  // Indexes bricks(), dead bricks included
+    const PowerUpPool &powerUps() const { return m_powerUps; }
+    
+    // Events accumulate across steps until taken by the front-end
+    void takeEvents(std::vector<GameEvent> &out);
+    void clearEvents() { m_events.clear(); }
+    
+    static constexpr qreal WIDTH = 800.0;
+    static constexpr qreal HEIGHT = 600.0;
+    static constexpr int DEFAULT_TICK_RATE = 120;
+    static constexpr int MAX_CONTACTS_PER_TICK = 8;
+    static constexpr int STARTING_LIVES = 3;
+    static constexpr qreal INVULNERABILITY_TIME = 2.0;
+    static constexpr qreal BALL_RADIUS = 8.0;
+    static constexpr qreal DEFAULT_BALL_SPEED = 200.0;
+    static constexpr int MULTI_BALL_LIMIT = 64;
+    
+    static constexpr qreal BRICK_WIDTH = 70.0;
+    static constexpr qreal BRICK_HEIGHT = 25.0;
+    static constexpr qreal BRICK_PADDING = 5.0;
+    static constexpr int BRICK_COLUMNS = 10;
+    static constexpr qreal BRICK_OFFSET_Y = 50.0;
+
+private:
+    void resetBall();
+    void loseLife(const QPointF &position);
+    void updateTimers(qreal delta);
+    void moveBalls(qreal delta);
+    void sweepBall(int ball, qreal delta);
+    bool findBrickContact(const QPointF &start, const QPointF &motion, qreal radius,
+                          int &brick, SweepHit &hit);
+    void bounceOffPaddle(int ball);
+    void hitBrick(int ball, int index, const QPointF &normal);
+    void splitBalls();
+    void checkPowerUpCollisions();
+    void checkWorldState();
+    void applyPowerUp(PowerUpType type);
+    void spawnPowerUp(qreal x, qreal y);
+    
+    std::unique_ptr<Paddle> m_paddle;
+    BallArray m_balls;
+    std::vector<quint8> m_sweptBalls;
+    BrickField m_bricks;
+    BrickGrid m_brickGrid;
+    std::vector<int> m_brickCandidates;
+    PowerUpPool m_powerUps;
+    std::vector<GameEvent> m_events;
+    Random m_dropRandom;
+    
+    WorldState m_state;
+    qreal m_tickTime;
+    quint64 m_tick;
+    quint32 m_brickLayoutId;
+    int m_score;
+    int m_lives;
+    qreal m_levelBallSpeed;
+    bool m_invulnerable;
+    qreal m_invulnerabilityTimer;
+    qreal m_paddleSizeTimer;
+    qreal m_ballSpeedTimer;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "HeadlessGame.h"
+#include "Level.h"
+
+int GameResult::levelsCleared() const
+{
+    int cleared = 0;
+    for (const LevelResult &level : levels) {
+        cleared += level.cleared ? 1 : 0;
+    }
+    return cleared;
+}
+
+HeadlessGame::HeadlessGame(std::vector<std::shared_ptr<const Level>> levels, InputSource input)
+    : m_levels(std::move(levels)), m_input(std::move(input)), m_maxTicks(DEFAULT_MAX_TICKS)
+{
+}
+
+GameResult HeadlessGame::play(quint32 seed) const
+{
+    GameResult result;
+    result.seed = seed;
+    
+    GameWorld world;
+    world.newGame(seed);
+    std::vector<GameEvent> events;
+    
+    for (size_t index = 0; index < m_levels.size(); ++index) {
+        LevelResult level;
+        level.levelId = static_cast<int>(index) + 1;
+        
+        world.loadLevel(*m_levels[index]);
+        const quint64 start = world.tick();
+        while (world.state() == WorldState::Playing && world.tick() < m_maxTicks) {
+            world.step(m_input(world));
+            
+            world.takeEvents(events);
+            for (const GameEvent &event : events) {
+                if (event.type == GameEvent::Type::LifeLost) {
+                    ++level.livesLost;
+                } else if (event.type == GameEvent::Type::PowerUpCollected) {
+                    ++level.powerUps[static_cast<int>(event.powerUp)];
+                }
+            }
+        }
+        
+        level.ticks = world.tick() - start;
+        level.cleared = world.state() == WorldState::LevelCleared;
+        result.levels.push_back(level);
+        if (!level.cleared) {
+            break;
+        }
+    }
+    
+    result.ticks = world.tick();
+    result.score = world.score();
+    if (world.state() == WorldState::GameOver) {
+        result.outcome = GameResult::Outcome::Lost;
+    } else if (result.levelsCleared() == static_cast<int>(m_levels.size())) {
+        result.outcome = GameResult::Outcome::Won;
+    } else {
+        result.outcome = GameResult::Outcome::TimedOut;
+    }
+    return result;
+}
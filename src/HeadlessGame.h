@@ -0,0 +1,63 @@
+#ifndef HEADLESSGAME_H
+#define HEADLESSGAME_H
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "GameWorld.h"
+
+class Level;
+
+struct LevelResult
+{
+    int levelId = 0;          // 1-based position in the level list
+    quint64 ticks = 0;        // Spent on this level
+    int livesLost = 0;
+    bool cleared = false;
+    std::array<int, PowerUp::TYPE_COUNT> powerUps{};  // Collected, by type
+};
+
+struct GameResult
+{
+    enum class Outcome {
+        Won,        // Every level cleared
+        Lost,       // Out of lives
+        TimedOut    // Hit the tick limit
+    };
+    
+    quint32 seed = 0;
+    Outcome outcome = Outcome::Lost;
+    quint64 ticks = 0;
+    int score = 0;
+    std::vector<LevelResult> levels;  // Up to and including the last one played
+    
+    int levelsCleared() const;
+};
+
+// Plays whole games on a GameWorld with no front-end: the levels in order,
+// moving on as each is cleared, until the last one is cleared, the lives
+// run out or the tick limit is reached. Instances share nothing but the
+// immutable levels, so one per thread can run flat out.
+class HeadlessGame
+{
+public:
+    using InputSource = std::function<PaddleInput(const GameWorld &world)>;
+    
+    HeadlessGame(std::vector<std::shared_ptr<const Level>> levels, InputSource input);
+    
+    void setMaxTicks(quint64 ticks) { m_maxTicks = ticks; }
+    quint64 maxTicks() const { return m_maxTicks; }
+    
+    GameResult play(quint32 seed) const;
+    
+    // Half an hour of game time
+    static constexpr quint64 DEFAULT_MAX_TICKS = 30ull * 60 * GameWorld::DEFAULT_TICK_RATE;
+
+private:
+    std::vector<std::shared_ptr<const Level>> m_levels;
+    InputSource m_input;
+    quint64 m_maxTicks;
+};
+
+#endif
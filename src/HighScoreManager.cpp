@@ -7,6 +7,12 @@ HighScoreManager::HighScoreManager(QObject *parent)
     loadHighScores();
 }
 
+HighScoreManager::HighScoreManager(const QString &settingsFile, QObject *parent)
+    : QObject(parent), m_settings(settingsFile, QSettings::IniFormat)
+{
+    loadHighScores();
+}
+
 void HighScoreManager::loadHighScores()
 {
     m_highScores.clear();
@@ -23,6 +23,9 @@ class HighScoreManager : public QObject
 
 public:
     explicit HighScoreManager(QObject *parent = nullptr);
+    // Keeps the table in the INI file at settingsFile instead of the
+    // platform's settings store
+    explicit HighScoreManager(const QString &settingsFile, QObject *parent = nullptr);
     
     bool isHighScore(int score) const;
     void addHighScore(const QString &name, int score);
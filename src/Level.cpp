@@ -4,6 +4,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
+#include <cstring>
 
 Level::Level()
     : m_levelNumber(1), m_name("Untitled"), m_ballSpeed(200.0)
@@ -52,6 +53,37 @@ bool Level::loadFromJson(const QString &filePath)
     return true;
 }
 
+quint32 Level::checksum() const
+{
+    quint32 hash = 2166136261u;
+    auto mixBytes = [&hash](const void *data, size_t size) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+    };
+    auto mix = [&mixBytes](const auto &value) {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        mixBytes(bytes, sizeof(bytes));
+    };
+    
+    mix(static_cast<qint32>(m_levelNumber));
+    mix(static_cast<double>(m_ballSpeed));
+    for (const BrickData &brick : m_bricks) {
+        mix(static_cast<qint32>(brick.row));
+        mix(static_cast<qint32>(brick.col));
+        mix(static_cast<qint32>(brick.hitPoints));
+        mix(static_cast<quint32>(brick.color.rgba()));
+    }
+    
+    const QByteArray name = m_name.toUtf8();
+    const QByteArray description = m_description.toUtf8();
+    mixBytes(name.constData(), name.size());
+    mixBytes(description.constData(), description.size());
+    return hash;
+}
+
 QColor Level::parseColor(const QString &colorStr) const
 {
     // Handle named colors
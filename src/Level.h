@@ -29,8 +29,14 @@ public:
     qreal ballSpeed() const { return m_ballSpeed; }
     const std::vector<BrickData>& bricks() const { return m_bricks; }
     int totalBricks() const { return static_cast<int>(m_bricks.size()); }
+    
+    // FNV-1a over the level's content; equal for a level whether it came
+    // from JSON or a compiled pack
+    quint32 checksum() const;
 
 private:
+    friend class LevelPack;
+    
     int m_levelNumber;
     QString m_name;
     QString m_description;
@@ -1,53 +1,139 @@
 #include "LevelManager.h"
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
 #include <QCoreApplication>
+#include <QCollator>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QtConcurrent>
 #include <QDebug>
+#include <algorithm>
+#include <set>
+#include <utility>
+#include "GameWorld.h"
+
+namespace {
+
+// Bricks have to leave the lower part of the field to the ball and paddle
+constexpr qreal MAX_BRICK_AREA = 0.75;
+
+// Result of checking one level file of a user pack on a worker thread
+struct ScannedLevel
+{
+    QString path;
+    QString name;
+    quint32 checksum = 0;
+    QString error;  // Empty if the level is usable
+};
+
+// User packs are untrusted: reject levels the game could not play sensibly,
+// or that qt-arkanoid-levelc could not compile
+QString validateLevel(const Level &level)
+{
+    if (level.bricks().empty()) {
+        return "has no bricks";
+    }
+    if (!(level.ballSpeed() > 0.0)) {
+        return "has a ball speed that is not positive";
+    }
+    
+    std::set<std::pair<int, int>> cells;
+    for (const BrickData &brick : level.bricks()) {
+        const qreal bottom = GameWorld::BRICK_OFFSET_Y +
+                             brick.row * (GameWorld::BRICK_HEIGHT + GameWorld::BRICK_PADDING) +
+                             GameWorld::BRICK_HEIGHT;
+        if (brick.col < 0 || brick.col >= GameWorld::BRICK_COLUMNS || brick.row < 0 ||
+            bottom > GameWorld::HEIGHT * MAX_BRICK_AREA) {
+            return QString("has a brick outside the field at row %1, column %2").arg(brick.row).arg(brick.col);
+        }
+        if (brick.hitPoints < 1 || brick.hitPoints > 0xff) {
+            return QString("has a brick with %1 hit points").arg(brick.hitPoints);
+        }
+        if (!cells.insert({ brick.row, brick.col }).second) {
+            return QString("has two bricks at row %1, column %2").arg(brick.row).arg(brick.col);
+        }
+    }
+    return QString();
+}
+
+ScannedLevel scanLevel(const QString &path)
+{
+    ScannedLevel scanned;
+    scanned.path = path;
+    
+    Level level;
+    if (!level.loadFromJson(path)) {
+        scanned.error = "could not be parsed";
+        return scanned;
+    }
+    
+    scanned.error = validateLevel(level);
+    scanned.name = level.name();
+    scanned.checksum = level.checksum();
+    return scanned;
+}
+
+} // namespace
 
 LevelManager::LevelManager(QObject *parent)
-    : QObject(parent), m_currentLevel(1), m_highestUnlockedLevel(1),
-      m_settings("QtArkanoid", "Arkanoid")
+    : QObject(parent), m_residentLimit(DEFAULT_RESIDENT_LIMIT), m_currentLevel(1),
+      m_highestUnlockedLevel(1), m_settings("QtArkanoid", "Arkanoid")
 {
     loadProgress();
-    createDefaultLevels();
 }
 
 bool LevelManager::loadLevels()
 {
-    m_levels.clear();
+    QElapsedTimer timer;
+    timer.start();
     
-    // Try to load levels from Qt resources first
+    m_index.clear();
+    m_resident.clear();
+    m_pack.close();
+    
+    // The compiled pack is preferred; JSON stays the authoring format and
+    // the fallback when no pack was built
+    if (!indexPack(QCoreApplication::applicationDirPath() + "/levels/" + PACK_FILE_NAME)) {
+        indexBuiltinJson();
+    }
+    
+    // User packs follow the built-in levels
+    const QStringList packs = discoverPackDirectories();
+    for (const QString &pack : packs) {
+        indexPackDirectory(pack);
+    }
+    
+    // Last resort: Create default levels programmatically
+    if (m_index.empty()) {
+        qWarning() << "No levels found in resources or files, creating default levels";
+        createDefaultLevels();
+    }
+    
+    qDebug() << "Indexed" << m_index.size() << "levels," << packs.size() << "user packs, in"
+             << timer.elapsed() << "ms";
+    return !m_index.empty();
+}
+
+void LevelManager::indexBuiltinJson()
+{
+    // Try the levels in Qt resources
     QStringList resourceLevels = {
         ":/levels/resources/levels/level1.json",
         ":/levels/resources/levels/level2.json",
         ":/levels/resources/levels/level3.json"
     };
     
-    bool anyLoaded = false;
     for (const QString &resourcePath : resourceLevels) {
-        QFile file(resourcePath);
-        if (!file.exists()) {
+        if (!QFile::exists(resourcePath)) {
             qWarning() << "Resource level file not found:" << resourcePath;
             continue;
         }
-        
-        if (!file.open(QIODevice::ReadOnly)) {
-            qWarning() << "Failed to open resource level:" << resourcePath << file.errorString();
-            continue;
-        }
-        
-        auto level = std::make_unique<Level>();
-        if (level->loadFromJson(resourcePath)) {
-            m_levels.push_back(std::move(level));
-            anyLoaded = true;
-            qDebug() << "Loaded level from resource:" << resourcePath;
-        } else {
-            qWarning() << "Failed to parse level from resource:" << resourcePath;
-        }
+        indexJson(resourcePath);
     }
     
-    // Fallback: Try to load from external directory
-    if (!anyLoaded) {
+    // Fallback: Try the external directory
+    if (m_index.empty()) {
         QString levelsDir = QCoreApplication::applicationDirPath() + "/levels";
         QDir dir(levelsDir);
         
@@ -57,89 +143,234 @@ bool LevelManager::loadLevels()
             QStringList levelFiles = dir.entryList(filters, QDir::Files, QDir::Name);
             
             for (const QString &filename : levelFiles) {
-                QString filePath = dir.filePath(filename);
-                QFile file(filePath);
-                
-                if (!file.open(QIODevice::ReadOnly)) {
-                    qWarning() << "Failed to open level file:" << filePath << file.errorString();
-                    continue;
-                }
-                
-                auto level = std::make_unique<Level>();
-                if (level->loadFromJson(filePath)) {
-                    m_levels.push_back(std::move(level));
-                    anyLoaded = true;
-                    qDebug() << "Loaded level from file:" << filePath;
-                } else {
-                    qWarning() << "Failed to parse level file:" << filePath;
-                }
+                indexJson(dir.filePath(filename));
             }
         }
     }
+}
+
+void LevelManager::addPackDirectory(const QString &path)
+{
+    if (!m_packDirectories.contains(path)) {
+        m_packDirectories << path;
+    }
+}
+
+QStringList LevelManager::discoverPackDirectories() const
+{
+    // Every subdirectory of a pack root is one pack; directories added with
+    // addPackDirectory() are packs themselves
+    QStringList roots;
+    roots << QCoreApplication::applicationDirPath() + "/" + PACK_ROOT_NAME;
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (!dataDir.isEmpty()) {
+        roots << dataDir + "/" + PACK_ROOT_NAME;
+    }
     
-    // Last resort: Create default levels programmatically
-    if (!anyLoaded) {
-        qWarning() << "No levels found in resources or files, creating default levels";
-        createDefaultLevels();
-        return !m_levels.empty();
+    QCollator collator;
+    collator.setNumericMode(true);
+    
+    QStringList packs;
+    for (const QString &root : roots) {
+        QDir dir(root);
+        if (!dir.exists()) {
+            continue;
+        }
+        
+        QStringList names = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        std::sort(names.begin(), names.end(), collator);
+        for (const QString &name : names) {
+            packs << dir.filePath(name);
+        }
     }
     
-    return !m_levels.empty();
+    for (const QString &path : m_packDirectories) {
+        if (!packs.contains(path)) {
+            packs << path;
+        }
+    }
+    return packs;
 }
 
-void LevelManager::createDefaultLevels()
+int LevelManager::indexPackDirectory(const QString &path)
+{
+    // Files are ordered the way people number them: level2 before level10
+    QDir dir(path);
+    QStringList names = dir.entryList({ "*.json" }, QDir::Files);
+    QCollator collator;
+    collator.setNumericMode(true);
+    std::sort(names.begin(), names.end(), collator);
+    
+    QStringList files;
+    files.reserve(names.size());
+    for (const QString &name : names) {
+        files << dir.filePath(name);
+    }
+    
+    // Every file is parsed and validated across the pool; the bodies are
+    // dropped again and only the index entries kept
+    const QList<ScannedLevel> scanned = QtConcurrent::blockingMapped<QList<ScannedLevel>>(files, scanLevel);
+    
+    int indexed = 0;
+    for (const ScannedLevel &level : scanned) {
+        if (!level.error.isEmpty()) {
+            qWarning() << "Skipping level" << level.path << level.error;
+            continue;
+        }
+        
+        LevelInfo info;
+        info.id = totalLevels() + 1;
+        info.name = level.name;
+        info.path = level.path;
+        info.checksum = level.checksum;
+        info.source = LevelInfo::Source::Json;
+        m_index.push_back(info);
+        ++indexed;
+    }
+    
+    qDebug() << "Indexed" << indexed << "of" << files.size() << "levels from pack:" << path;
+    return indexed;
+}
+
+bool LevelManager::indexPack(const QString &filePath)
 {
-    m_levels.clear();
-    createLevel1();
-    createLevel2();
-    createLevel3();
-    createLevel4();
-    createLevel5();
+    if (!QFile::exists(filePath) || !m_pack.open(filePath)) {
+        return false;
+    }
+    
+    // Names and checksums come straight from the level table
+    m_index.reserve(m_pack.levelCount());
+    for (int i = 0; i < m_pack.levelCount(); ++i) {
+        LevelInfo info;
+        info.id = totalLevels() + 1;
+        info.name = m_pack.levelName(i);
+        info.path = filePath;
+        info.packIndex = i;
+        info.checksum = m_pack.levelChecksum(i);
+        info.source = LevelInfo::Source::Pack;
+        m_index.push_back(info);
+    }
+    
+    qDebug() << "Indexed" << m_index.size() << "levels from pack:" << filePath;
+    return !m_index.empty();
 }
 
-void LevelManager::createLevel1()
+void LevelManager::indexJson(const QString &filePath)
 {
-    auto level = std::make_unique<Level>();
-    // Simple level with 5 rows of bricks
-    // For now, create levels programmatically
-    m_levels.push_back(std::move(level));
+    // The real name is read when the level is first parsed
+    LevelInfo info;
+    info.id = totalLevels() + 1;
+    info.name = QFileInfo(filePath).completeBaseName();
+    info.path = filePath;
+    info.source = LevelInfo::Source::Json;
+    m_index.push_back(info);
 }
 
-void LevelManager::createLevel2()
+void LevelManager::createDefaultLevels()
 {
-    auto level = std::make_unique<Level>();
-    m_levels.push_back(std::move(level));
+    m_index.clear();
+    m_resident.clear();
+    for (int i = 1; i <= 5; ++i) {
+        LevelInfo info;
+        info.id = i;
+        info.name = QString("Level %1").arg(i);
+        info.source = LevelInfo::Source::Builtin;
+        m_index.push_back(info);
+    }
 }
 
-void LevelManager::createLevel3()
+std::shared_ptr<const Level> LevelManager::parseLevel(const LevelInfo &info) const
 {
-    auto level = std::make_unique<Level>();
-    m_levels.push_back(std::move(level));
+    auto level = std::make_shared<Level>();
+    switch (info.source) {
+        case LevelInfo::Source::Pack:
+            // readLevel() checks the body against the indexed checksum
+            if (!m_pack.readLevel(info.packIndex, *level)) {
+                return nullptr;
+            }
+            break;
+        case LevelInfo::Source::Json:
+            if (!level->loadFromJson(info.path)) {
+                qWarning() << "Failed to parse level file:" << info.path;
+                return nullptr;
+            }
+            // Pack files were validated when indexed (built-in ones carry no
+            // checksum); one edited since then is checked again before the
+            // index takes its new contents
+            if (info.checksum != 0 && level->checksum() != info.checksum) {
+                const QString error = validateLevel(*level);
+                if (!error.isEmpty()) {
+                    qWarning() << "Rejecting changed level" << info.path << error;
+                    return nullptr;
+                }
+                qWarning() << "Level file changed since it was indexed:" << info.path;
+            }
+            break;
+        case LevelInfo::Source::Builtin:
+            break;
+    }
+    return level;
 }
 
-void LevelManager::createLevel4()
+std::shared_ptr<const Level> LevelManager::getCurrentLevel() const
 {
-    auto level = std::make_unique<Level>();
-    m_levels.push_back(std::move(level));
+    return level(m_currentLevel);
 }
 
-void LevelManager::createLevel5()
+std::shared_ptr<const Level> LevelManager::level(int levelNumber) const
 {
-    auto level = std::make_unique<Level>();
-    m_levels.push_back(std::move(level));
+    if (levelNumber < 1 || levelNumber > totalLevels()) {
+        return nullptr;
+    }
+    
+    LevelInfo info;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (std::shared_ptr<const Level> resident = touchResident(levelNumber)) {
+            return resident;
+        }
+        info = m_index[levelNumber - 1];
+    }
+    
+    // Parsed without the lock, so a prefetch never stalls the GUI thread
+    std::shared_ptr<const Level> parsed = parseLevel(info);
+    if (!parsed) {
+        return nullptr;
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    if (std::shared_ptr<const Level> resident = touchResident(levelNumber)) {
+        return resident;  // Another thread got there first
+    }
+    
+    // parseLevel() has validated a changed file, so the entry can follow it
+    LevelInfo &entry = m_index[levelNumber - 1];
+    if (entry.source == LevelInfo::Source::Json) {
+        entry.name = parsed->name();
+        entry.checksum = parsed->checksum();
+    }
+    m_resident.push_back({ levelNumber, parsed });
+    if (static_cast<int>(m_resident.size()) > m_residentLimit) {
+        m_resident.erase(m_resident.begin());
+    }
+    return parsed;
 }
 
-const Level* LevelManager::getCurrentLevel() const
+std::shared_ptr<const Level> LevelManager::touchResident(int levelNumber) const
 {
-    if (m_currentLevel > 0 && m_currentLevel <= static_cast<int>(m_levels.size())) {
-        return m_levels[m_currentLevel - 1].get();
+    // The cache holds a handful of levels, so a linear scan is enough
+    for (auto it = m_resident.begin(); it != m_resident.end(); ++it) {
+        if (it->id == levelNumber) {
+            std::rotate(it, it + 1, m_resident.end());
+            return m_resident.back().level;
+        }
     }
     return nullptr;
 }
 
 bool LevelManager::nextLevel()
 {
-    if (m_currentLevel < static_cast<int>(m_levels.size())) {
+    if (m_currentLevel < totalLevels()) {
         m_currentLevel++;
         if (m_currentLevel > m_highestUnlockedLevel) {
             m_highestUnlockedLevel = m_currentLevel;
@@ -152,11 +383,32 @@ bool LevelManager::nextLevel()
 
 void LevelManager::resetToLevel(int levelNumber)
 {
-    if (levelNumber > 0 && levelNumber <= static_cast<int>(m_levels.size())) {
+    if (levelNumber > 0 && levelNumber <= totalLevels()) {
         m_currentLevel = levelNumber;
     }
 }
 
+void LevelManager::setResidentLimit(int levels)
+{
+    QMutexLocker locker(&m_mutex);
+    m_residentLimit = qMax(1, levels);
+    while (static_cast<int>(m_resident.size()) > m_residentLimit) {
+        m_resident.erase(m_resident.begin());
+    }
+}
+
+std::vector<LevelInfo> LevelManager::levelIndex() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_index;
+}
+
+int LevelManager::residentCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_resident.size());
+}
+
 void LevelManager::saveProgress()
 {
     m_settings.setValue("progress/currentLevel", m_currentLevel);
@@ -3,10 +3,27 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QSettings>
+#include <QMutex>
 #include <vector>
 #include <memory>
 #include "Level.h"
+#include "LevelPack.h"
+
+// One row of the level index. The index is all that is built at startup;
+// a level body is parsed the first time it is asked for.
+struct LevelInfo
+{
+    enum class Source { Pack, Json, Builtin };
+    
+    int id = 0;             // 1-based play order, as used by progress and replays
+    QString name;
+    QString path;           // Pack or JSON file
+    int packIndex = -1;
+    quint32 checksum = 0;   // Level::checksum(); 0 until a JSON level is first parsed
+    Source source = Source::Builtin;
+};
 
 class LevelManager : public QObject
 {
@@ -15,34 +32,74 @@ class LevelManager : public QObject
 public:
     explicit LevelManager(QObject *parent = nullptr);
     
+    // Builds the level index: the built-in levels (pack, else JSON) followed
+    // by every user pack. Built-in bodies are not parsed here; user packs
+    // are parsed and validated in parallel and bad levels left out.
     bool loadLevels();
     void createDefaultLevels();
     
+    // A user pack is a directory of JSON levels, played in natural file name
+    // order. Subdirectories of <executable dir>/levelpacks and of the app data
+    // location's levelpacks are found automatically; others can be added
+    // before loadLevels().
+    void addPackDirectory(const QString &path);
+    QStringList packDirectories() const { return m_packDirectories; }
+    QStringList discoverPackDirectories() const;
+    
     int currentLevelNumber() const { return m_currentLevel; }
-    int totalLevels() const { return static_cast<int>(m_levels.size()); }
-    bool hasNextLevel() const { return m_currentLevel < static_cast<int>(m_levels.size()); }
+    int totalLevels() const { return static_cast<int>(m_index.size()); }
+    bool hasNextLevel() const { return m_currentLevel < totalLevels(); }
+    std::vector<LevelInfo> levelIndex() const;
     
-    const Level* getCurrentLevel() const;
+    // Parsed on demand and kept in a small LRU cache. A returned level stays
+    // valid for as long as the caller holds it, even once evicted. level()
+    // may be called from a worker thread to prefetch; everything else
+    // belongs to the GUI thread.
+    std::shared_ptr<const Level> getCurrentLevel() const;
+    std::shared_ptr<const Level> level(int levelNumber) const;
     bool nextLevel();
     void resetToLevel(int levelNumber);
     
+    void setResidentLimit(int levels);
+    int residentLimit() const { return m_residentLimit; }
+    int residentCount() const;
+    
     // Progress tracking
     void saveProgress();
     void loadProgress();
     int getHighestUnlockedLevel() const { return m_highestUnlockedLevel; }
     void unlockLevel(int levelNumber);
+    
+    // Written by qt-arkanoid-levelc into <executable dir>/levels
+    static constexpr const char *PACK_FILE_NAME = "levels.pack";
+    static constexpr const char *PACK_ROOT_NAME = "levelpacks";
+    static constexpr int DEFAULT_RESIDENT_LIMIT = 8;
 
 private:
-    std::vector<std::unique_ptr<Level>> m_levels;
+    struct ResidentLevel
+    {
+        int id;
+        std::shared_ptr<const Level> level;
+    };
+    
+    // m_index is mutable because a JSON level's name and checksum are only
+    // known once it has been parsed
+    mutable std::vector<LevelInfo> m_index;
+    mutable std::vector<ResidentLevel> m_resident;  // Most recently used last
+    mutable QMutex m_mutex;  // Guards m_resident and the parsed fields of m_index
+    int m_residentLimit;
     int m_currentLevel;
     int m_highestUnlockedLevel;
     QSettings m_settings;
+    LevelPack m_pack;
+    QStringList m_packDirectories;
     
-    void createLevel1();
-    void createLevel2();
-    void createLevel3();
-    void createLevel4();
-    void createLevel5();
+    bool indexPack(const QString &filePath);
+    void indexBuiltinJson();
+    int indexPackDirectory(const QString &path);
+    void indexJson(const QString &filePath);
+    std::shared_ptr<const Level> parseLevel(const LevelInfo &info) const;
+    std::shared_ptr<const Level> touchResident(int levelNumber) const;  // Caller holds m_mutex
 };
 
 #endif
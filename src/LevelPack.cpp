@@ -0,0 +1,274 @@
+#include "LevelPack.h"
+#include "Level.h"
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = { 'A', 'R', 'K', 'L' };
+
+// Offsets inside a level table record
+enum RecordField {
+    BallSpeed = 0,        // f64
+    LevelNumber = 8,      // i32
+    PaletteOffset = 12,
+    PaletteCount = 16,
+    BricksOffset = 20,
+    BrickCount = 24,
+    NameOffset = 28,
+    NameLength = 32,
+    DescriptionOffset = 36,
+    DescriptionLength = 40,
+    Checksum = 44
+};
+
+// Packed brick word
+constexpr int COLUMN_SHIFT = 0;
+constexpr int ROW_SHIFT = 8;
+constexpr int HIT_POINTS_SHIFT = 16;
+constexpr int PALETTE_SHIFT = 24;
+
+quint32 readU32(const uchar *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+void appendU32(QByteArray &out, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+void setU32(QByteArray &out, int offset, quint32 value)
+{
+    qToLittleEndian(value, reinterpret_cast<uchar *>(out.data()) + offset);
+}
+
+void alignTo4(QByteArray &out)
+{
+    while (out.size() % 4) {
+        out.append('\0');
+    }
+}
+
+} // namespace
+
+LevelPack::LevelPack()
+    : m_data(nullptr), m_size(0), m_levelCount(0)
+{
+}
+
+LevelPack::~LevelPack()
+{
+    close();
+}
+
+bool LevelPack::open(const QString &filePath)
+{
+    close();
+    
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    const qint64 size = m_file.size();
+    const uchar *data = size >= HEADER_SIZE ? m_file.map(0, size) : nullptr;
+    if (!data || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        qFromLittleEndian<quint16>(data + 4) != FORMAT_VERSION ||
+        readU32(data + 8) != static_cast<quint64>(size)) {
+        qWarning() << "Invalid level pack:" << filePath;
+        m_file.close();
+        return false;
+    }
+    
+    const int levelCount = qFromLittleEndian<quint16>(data + 6);
+    if (HEADER_SIZE + static_cast<qint64>(levelCount) * RECORD_SIZE > size) {
+        qWarning() << "Truncated level pack:" << filePath;
+        m_file.close();
+        return false;
+    }
+    
+    m_data = data;
+    m_size = size;
+    m_levelCount = levelCount;
+    return true;
+}
+
+void LevelPack::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+    }
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_levelCount = 0;
+}
+
+bool LevelPack::readLevel(int index, Level &level) const
+{
+    if (!m_data || index < 0 || index >= m_levelCount) {
+        return false;
+    }
+    
+    const uchar *record = recordAt(index);
+    const quint32 paletteOffset = readU32(record + PaletteOffset);
+    const quint32 paletteCount = readU32(record + PaletteCount);
+    const quint32 bricksOffset = readU32(record + BricksOffset);
+    const quint32 brickCount = readU32(record + BrickCount);
+    const quint32 nameOffset = readU32(record + NameOffset);
+    const quint32 nameLength = readU32(record + NameLength);
+    const quint32 descriptionOffset = readU32(record + DescriptionOffset);
+    const quint32 descriptionLength = readU32(record + DescriptionLength);
+    
+    auto fits = [this](quint64 offset, quint64 bytes) { return offset + bytes <= static_cast<quint64>(m_size); };
+    if (!fits(paletteOffset, paletteCount * 4ull) || !fits(bricksOffset, brickCount * 4ull) ||
+        !fits(nameOffset, nameLength) || !fits(descriptionOffset, descriptionLength)) {
+        qWarning() << "Corrupt level" << index << "in pack" << m_file.fileName();
+        return false;
+    }
+    
+    const quint64 speedBits = qFromLittleEndian<quint64>(record + BallSpeed);
+    std::memcpy(&level.m_ballSpeed, &speedBits, sizeof(speedBits));
+    level.m_levelNumber = static_cast<qint32>(readU32(record + LevelNumber));
+    level.m_name = QString::fromUtf8(reinterpret_cast<const char *>(m_data + nameOffset), nameLength);
+    level.m_description = QString::fromUtf8(reinterpret_cast<const char *>(m_data + descriptionOffset),
+                                            descriptionLength);
+    
+    const uchar *palette = m_data + paletteOffset;
+    const uchar *bricks = m_data + bricksOffset;
+    level.m_bricks.clear();
+    level.m_bricks.reserve(brickCount);
+    for (quint32 i = 0; i < brickCount; ++i) {
+        const quint32 word = readU32(bricks + i * 4);
+        const quint32 colorIndex = (word >> PALETTE_SHIFT) & 0xff;
+        if (colorIndex >= paletteCount) {
+            qWarning() << "Corrupt brick in level" << index << "of pack" << m_file.fileName();
+            return false;
+        }
+        
+        level.m_bricks.emplace_back(static_cast<int>((word >> ROW_SHIFT) & 0xff),
+                                    static_cast<int>((word >> COLUMN_SHIFT) & 0xff),
+                                    QColor::fromRgba(readU32(palette + colorIndex * 4)),
+                                    static_cast<int>((word >> HIT_POINTS_SHIFT) & 0xff));
+    }
+    
+    if (level.checksum() != readU32(record + Checksum)) {
+        qWarning() << "Checksum mismatch for level" << index << "in pack" << m_file.fileName();
+        return false;
+    }
+    return true;
+}
+
+QString LevelPack::levelName(int index) const
+{
+    if (!m_data || index < 0 || index >= m_levelCount) {
+        return QString();
+    }
+    
+    const quint32 nameOffset = readU32(recordAt(index) + NameOffset);
+    const quint32 nameLength = readU32(recordAt(index) + NameLength);
+    if (static_cast<quint64>(nameOffset) + nameLength > static_cast<quint64>(m_size)) {
+        return QString();
+    }
+    return QString::fromUtf8(reinterpret_cast<const char *>(m_data + nameOffset), nameLength);
+}
+
+quint32 LevelPack::levelChecksum(int index) const
+{
+    if (!m_data || index < 0 || index >= m_levelCount) {
+        return 0;
+    }
+    return readU32(recordAt(index) + Checksum);
+}
+
+QByteArray LevelPack::compile(const std::vector<const Level *> &levels, QString *error)
+{
+    auto fail = [error](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return QByteArray();
+    };
+    
+    if (levels.size() > 0xffff) {
+        return fail(QString("Too many levels (%1)").arg(levels.size()));
+    }
+    
+    QByteArray out;
+    out.append(MAGIC, sizeof(MAGIC));
+    out.append(QByteArray(HEADER_SIZE - sizeof(MAGIC) + static_cast<int>(levels.size()) * RECORD_SIZE, '\0'));
+    qToLittleEndian(FORMAT_VERSION, reinterpret_cast<uchar *>(out.data()) + 4);
+    qToLittleEndian(static_cast<quint16>(levels.size()), reinterpret_cast<uchar *>(out.data()) + 6);
+    
+    for (size_t index = 0; index < levels.size(); ++index) {
+        const Level &level = *levels[index];
+        const int record = HEADER_SIZE + static_cast<int>(index) * RECORD_SIZE;
+        
+        // Palette in order of first use, so brick words stay small and stable
+        std::vector<QRgb> palette;
+        std::vector<quint32> words;
+        words.reserve(level.bricks().size());
+        for (const BrickData &brick : level.bricks()) {
+            if (brick.row < 0 || brick.row > 0xff || brick.col < 0 || brick.col > 0xff ||
+                brick.hitPoints < 1 || brick.hitPoints > 0xff) {
+                return fail(QString("Level %1: brick at row %2, column %3 is out of range")
+                                .arg(level.name()).arg(brick.row).arg(brick.col));
+            }
+            
+            const QRgb color = brick.color.rgba();
+            size_t colorIndex = 0;
+            while (colorIndex < palette.size() && palette[colorIndex] != color) {
+                ++colorIndex;
+            }
+            if (colorIndex == palette.size()) {
+                if (palette.size() > 0xff) {
+                    return fail(QString("Level %1 uses more than 256 colours").arg(level.name()));
+                }
+                palette.push_back(color);
+            }
+            
+            words.push_back(static_cast<quint32>(brick.col) << COLUMN_SHIFT |
+                            static_cast<quint32>(brick.row) << ROW_SHIFT |
+                            static_cast<quint32>(brick.hitPoints) << HIT_POINTS_SHIFT |
+                            static_cast<quint32>(colorIndex) << PALETTE_SHIFT);
+        }
+        
+        const qreal ballSpeed = level.ballSpeed();
+        quint64 speedBits = 0;
+        std::memcpy(&speedBits, &ballSpeed, sizeof(speedBits));
+        qToLittleEndian(speedBits, reinterpret_cast<uchar *>(out.data()) + record + BallSpeed);
+        setU32(out, record + LevelNumber, static_cast<quint32>(level.levelNumber()));
+        setU32(out, record + Checksum, level.checksum());
+        
+        setU32(out, record + PaletteOffset, static_cast<quint32>(out.size()));
+        setU32(out, record + PaletteCount, static_cast<quint32>(palette.size()));
+        for (QRgb color : palette) {
+            appendU32(out, color);
+        }
+        
+        setU32(out, record + BricksOffset, static_cast<quint32>(out.size()));
+        setU32(out, record + BrickCount, static_cast<quint32>(words.size()));
+        for (quint32 word : words) {
+            appendU32(out, word);
+        }
+        
+        const QByteArray name = level.name().toUtf8();
+        setU32(out, record + NameOffset, static_cast<quint32>(out.size()));
+        setU32(out, record + NameLength, static_cast<quint32>(name.size()));
+        out.append(name);
+        alignTo4(out);
+        
+        const QByteArray description = level.description().toUtf8();
+        setU32(out, record + DescriptionOffset, static_cast<quint32>(out.size()));
+        setU32(out, record + DescriptionLength, static_cast<quint32>(description.size()));
+        out.append(description);
+        alignTo4(out);
+    }
+    
+    setU32(out, 8, static_cast<quint32>(out.size()));
+    return out;
+}
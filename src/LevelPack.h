@@ -0,0 +1,60 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <vector>
+
+class Level;
+
+// Levels compiled from the JSON authoring format by qt-arkanoid-levelc.
+// The pack is memory-mapped and levels are decoded straight out of the
+// mapping: each brick is one packed 32-bit word (column, row, hit points,
+// palette index) and colours are a per-level palette of QRgb values, so
+// loading does no parsing, string compares or intermediate copies.
+//
+// Layout, all little-endian:
+//   header       magic "ARKL", u16 version, u16 level count, u32 file size, u32 0
+//   level table  one 48-byte record per level (see RecordField in LevelPack.cpp)
+//   data         per level: palette (u32 QRgb each), bricks (u32 each),
+//                name and description (UTF-8), each block 4-byte aligned
+class LevelPack
+{
+public:
+    LevelPack();
+    ~LevelPack();
+    
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString filePath() const { return m_file.fileName(); }
+    
+    int levelCount() const { return m_levelCount; }
+    bool readLevel(int index, Level &level) const;
+    
+    // Read from the level table alone, without decoding the level
+    QString levelName(int index) const;
+    quint32 levelChecksum(int index) const;
+    
+    // readLevel() fails if the decoded level does not match the checksum
+    // stored at compile time (Level::checksum())
+    //
+    // Returns an empty array and sets error if a level does not fit the
+    // format (more than 255 rows, columns, hit points or colours)
+    static QByteArray compile(const std::vector<const Level *> &levels, QString *error = nullptr);
+    
+    static constexpr quint16 FORMAT_VERSION = 2;
+    static constexpr int HEADER_SIZE = 16;
+    static constexpr int RECORD_SIZE = 48;
+
+private:
+    const uchar *recordAt(int index) const { return m_data + HEADER_SIZE + index * RECORD_SIZE; }
+    
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+    int m_levelCount;
+};
+
+#endif
@@ -0,0 +1,252 @@
+#include "PaddleController.h"
+#include "Collision.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Steers the paddle centre towards x, with a small dead zone so it settles
+// instead of twitching between left and right
+PaddleInput steerTowards(const GameWorld &world, qreal x)
+{
+    const QRectF paddle = world.paddle().rect();
+    const qreal target = qBound(paddle.width() / 2.0, x, GameWorld::WIDTH - paddle.width() / 2.0);
+    const qreal offset = target - paddle.center().x();
+    const qreal deadZone = world.paddle().speed() * world.tickTime() / 2.0;
+    
+    PaddleInput input;
+    input.left = offset < -deadZone;
+    input.right = offset > deadZone;
+    return input;
+}
+
+} // namespace
+
+PaddleInput BallFollower::update(const GameWorld &world)
+{
+    const BallArray &balls = world.balls();
+    int target = -1;
+    for (int i = 0; i < balls.size(); ++i) {
+        const bool falling = balls.velocity(i).y() > 0.0;
+        if (target < 0 || (falling && (balls.velocity(target).y() <= 0.0 || balls.y(i) > balls.y(target)))) {
+            target = i;
+        }
+    }
+    
+    if (target < 0) {
+        return steerTowards(world, GameWorld::WIDTH / 2.0);
+    }
+    
+    // The offset drifts a little over time so the ball cannot settle into a
+    // loop that never reaches the last bricks
+    const qreal side = balls.x(target) < GameWorld::WIDTH / 2.0 ? 1.0 : -1.0;
+    const qreal spread = 0.3 + 0.02 * static_cast<qreal>(world.tick() / GameWorld::DEFAULT_TICK_RATE % 5);
+    return steerTowards(world, balls.x(target) - side * spread * world.paddle().rect().width());
+}
+
+Autopilot::Autopilot()
+    : m_brickLayoutId(0), m_activeBricks(-1), m_brickCentreX(GameWorld::WIDTH / 2.0), m_paddleWidth(0.0)
+{
+}
+
+void Autopilot::reset()
+{
+    m_balls.clear();
+    m_activeBricks = -1;
+}
+
+PaddleInput Autopilot::update(const GameWorld &world)
+{
+    const BallArray &balls = world.balls();
+    const BrickField &bricks = world.bricks();
+    
+    // A new layout reroutes every ball; balls are swap-removed and split, so
+    // a changed count means indices no longer line up. The aim depends on
+    // the paddle width, which power-ups change.
+    if (world.brickLayoutId() != m_brickLayoutId || static_cast<int>(m_balls.size()) != balls.size() ||
+        world.paddle().width() != m_paddleWidth) {
+        m_brickLayoutId = world.brickLayoutId();
+        m_paddleWidth = world.paddle().width();
+        m_balls.assign(balls.size(), TrackedBall());
+        m_activeBricks = -1;
+    }
+    
+    // A destroyed brick only reroutes the balls whose path or aim touched it
+    if (bricks.activeCount() != m_activeBricks) {
+        m_activeBricks = bricks.activeCount();
+        
+        qreal sum = 0.0;
+        bricks.forEachActive([&](int index) {
+            sum += bricks.rect(index).center().x();
+        });
+        m_brickCentreX = m_activeBricks > 0 ? sum / m_activeBricks : GameWorld::WIDTH / 2.0;
+        
+        for (TrackedBall &tracked : m_balls) {
+            if (tracked.aimedAtCentre || std::any_of(tracked.bricks.begin(), tracked.bricks.end(),
+                                                     [&bricks](int index) { return !bricks.isActive(index); })) {
+                tracked.computed = false;
+            }
+        }
+    }
+    
+    int target = -1;
+    for (int i = 0; i < balls.size(); ++i) {
+        TrackedBall &tracked = m_balls[i];
+        if (!tracked.computed || tracked.velocity != balls.velocity(i)) {
+            tracked.computed = true;
+            tracked.velocity = balls.velocity(i);
+            tracked.bricks.clear();
+            tracked.aimedAtCentre = false;
+            tracked.prediction = predictLanding(world, balls.position(i), tracked.velocity, balls.radius(i),
+                                                &tracked.bricks);
+            tracked.landingTick = world.tick() + static_cast<quint64>(tracked.prediction.time / world.tickTime());
+            if (tracked.prediction.valid) {
+                tracked.paddleX = choosePaddleX(world, tracked, balls.speed(i), balls.radius(i));
+            }
+        }
+        
+        if (tracked.prediction.valid && (target < 0 || tracked.landingTick < m_balls[target].landingTick)) {
+            target = i;
+        }
+    }
+    
+    if (target < 0) {
+        return steerTowards(world, GameWorld::WIDTH / 2.0);
+    }
+    
+    return steerTowards(world, m_balls[target].paddleX);
+}
+
+qreal Autopilot::choosePaddleX(const GameWorld &world, TrackedBall &tracked, qreal speed, qreal radius)
+{
+    const Prediction &landing = tracked.prediction;
+    
+    // GameWorld::bounceOffPaddle() maps the hit position across the paddle
+    // to an angle a in -1..1 and scales the speed by 0.8 * sqrt(1 + a^2), so
+    // solve for the angle that restores the level's speed
+    const qreal width = world.paddle().rect().width();
+    const qreal ratio = world.levelBallSpeed() / (0.8 * qMax<qreal>(speed, 1.0));
+    const qreal keep = qBound<qreal>(0.5, std::sqrt(qMax<qreal>(ratio * ratio - 1.0, 0.0)), 0.9);
+    
+    // The paddle cannot leave the field, which rules out some angles for a
+    // ball landing near a wall
+    const qreal lowest = (landing.x - (GameWorld::WIDTH - width / 2.0)) / (width / 2.0);
+    const qreal highest = (landing.x - width / 2.0) / (width / 2.0);
+    
+    // Without a rebound that reaches a brick, send the ball towards the
+    // middle of the remaining bricks
+    const QPointF point(landing.x, world.paddle().rect().top() - radius);
+    qreal angle = qBound(lowest, m_brickCentreX >= landing.x ? keep : -keep, highest);
+    qreal best = std::numeric_limits<qreal>::infinity();
+    for (int i = 0; i < AIM_CANDIDATES; ++i) {
+        const qreal magnitude = keep + (i - AIM_CANDIDATES / 2) * AIM_SPACING;
+        for (qreal candidate : { -magnitude, magnitude }) {
+            if (candidate < lowest || candidate > highest) continue;
+            
+            const QPointF rebound(candidate * speed * 0.8, -speed * 0.8);
+            const Prediction path = predictLanding(world, point, rebound, radius);
+            if (path.hitsBrick) {
+                // Only the first brick decides between candidates
+                tracked.bricks.push_back(path.brick);
+                if (path.brickTime < best) {
+                    best = path.brickTime;
+                    angle = candidate;
+                }
+            }
+        }
+    }
+    tracked.aimedAtCentre = best == std::numeric_limits<qreal>::infinity();
+    return landing.x - angle * width / 2.0;
+}
+
+Autopilot::Prediction Autopilot::predictLanding(const GameWorld &world, const QPointF &position,
+                                                const QPointF &velocity, qreal radius, std::vector<int> *touched)
+{
+    const qreal line = world.paddle().rect().top() - radius;
+    const BrickField &bricks = world.bricks();
+    const qreal infinity = std::numeric_limits<qreal>::infinity();
+    
+    Prediction prediction;
+    QPointF point = position;
+    QPointF heading = velocity;
+    qreal elapsed = 0.0;
+    
+    for (int bounce = 0; bounce <= MAX_BOUNCES; ++bounce) {
+        // Walls and the paddle line are straight lines, so the time to each
+        // is a division; the earliest one bounds this leg
+        qreal step = infinity;
+        QPointF normal;
+        bool landing = false;
+        auto consider = [&](qreal time, const QPointF &wallNormal, bool isLine) {
+            if (time < step) {
+                step = qMax<qreal>(time, 0.0);
+                normal = wallNormal;
+                landing = isLine;
+            }
+        };
+        
+        if (heading.x() < 0.0) {
+            consider((radius - point.x()) / heading.x(), QPointF(1.0, 0.0), false);
+        } else if (heading.x() > 0.0) {
+            consider((GameWorld::WIDTH - radius - point.x()) / heading.x(), QPointF(-1.0, 0.0), false);
+        }
+        if (heading.y() < 0.0) {
+            consider((radius - point.y()) / heading.y(), QPointF(0.0, 1.0), false);
+        } else if (heading.y() > 0.0) {
+            consider((line - point.y()) / heading.y(), QPointF(), true);
+        }
+        
+        if (step == infinity) {
+            return prediction;  // Not moving
+        }
+        
+        // Only bricks in the grid cells under this leg's bounding box can cut
+        // it short; earliest contact wins and ties go to the lowest index, as
+        // in GameWorld::findBrickContact()
+        const QPointF motion = heading * step;
+        const QRectF reach = QRectF(point, point + motion).normalized().adjusted(-radius, -radius, radius, radius);
+        m_candidates.clear();
+        world.brickGrid().query(reach, m_candidates);
+        qreal brickTime = 1.0;
+        QPointF brickNormal;
+        int brick = -1;
+        for (int index : m_candidates) {
+            if (!bricks.isActive(index)) continue;
+            
+            SweepHit hit;
+            if (sweepCircleRect(point, motion, radius, bricks.rect(index), hit) &&
+                (hit.time < brickTime || (hit.time == brickTime && index < brick))) {
+                brickTime = hit.time;
+                brickNormal = hit.normal;
+                brick = index;
+            }
+        }
+        if (brick >= 0) {
+            step *= brickTime;
+            normal = brickNormal;
+            landing = false;
+            if (touched) {
+                touched->push_back(brick);
+            }
+            if (!prediction.hitsBrick) {
+                prediction.hitsBrick = true;
+                prediction.brickTime = elapsed + step;
+                prediction.brick = brick;
+            }
+        }
+        
+        point += heading * step;
+        elapsed += step;
+        if (landing) {
+            prediction.valid = true;
+            prediction.x = point.x();
+            prediction.time = elapsed;
+            return prediction;
+        }
+        
+        const qreal along = heading.x() * normal.x() + heading.y() * normal.y();
+        heading -= 2.0 * along * normal;
+    }
+    return prediction;
+}
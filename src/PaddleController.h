@@ -0,0 +1,86 @@
+#ifndef PADDLECONTROLLER_H
+#define PADDLECONTROLLER_H
+
+#include <QPointF>
+#include <vector>
+#include "GameWorld.h"
+
+// Decides the paddle input for the next tick from the world state. Called on
+// whatever thread steps the world, once per tick before GameWorld::step(),
+// so an implementation only ever sees its own world.
+class PaddleController
+{
+public:
+    virtual ~PaddleController() = default;
+    
+    virtual PaddleInput update(const GameWorld &world) = 0;
+    virtual void reset() {}
+};
+
+// Moves under the lowest ball that is coming down. Centre hits slow the ball
+// down, so it takes the ball on the outer part of the paddle, sending it
+// back towards the middle of the field.
+class BallFollower : public PaddleController
+{
+public:
+    PaddleInput update(const GameWorld &world) override;
+};
+
+// Predicts where every ball will cross the paddle line by marching its path
+// through wall and brick reflections, then places the paddle under the ball
+// that lands first. Of the hit positions that bring the ball back to the
+// level's speed (centre hits slow it down), it picks the one whose rebound
+// reaches a brick soonest.
+//
+// A prediction only changes when a ball's velocity does or a brick it
+// relies on is destroyed, so each one is cached with the bricks its path and
+// aim touched, and a typical tick costs a comparison per ball.
+class Autopilot : public PaddleController
+{
+public:
+    struct Prediction
+    {
+        bool valid = false;  // False if the path did not reach the paddle line within MAX_BOUNCES
+        qreal x = 0.0;
+        qreal time = 0.0;    // Seconds until the paddle line is reached
+        bool hitsBrick = false;
+        qreal brickTime = 0.0;  // Seconds until the first brick contact, if hitsBrick
+        int brick = -1;         // Index of that brick
+    };
+    
+    Autopilot();
+    
+    PaddleInput update(const GameWorld &world) override;
+    void reset() override;
+    
+    // Appends every brick the path reflects off to touched, if given
+    Prediction predictLanding(const GameWorld &world, const QPointF &position, const QPointF &velocity, qreal radius,
+                              std::vector<int> *touched = nullptr);
+    
+    static constexpr int MAX_BOUNCES = 24;
+    static constexpr int AIM_CANDIDATES = 3;   // Rebound angles tried on each side
+    static constexpr qreal AIM_SPACING = 0.05;
+
+private:
+    struct TrackedBall
+    {
+        bool computed = false;
+        QPointF velocity;
+        quint64 landingTick = 0;
+        Prediction prediction;
+        qreal paddleX = 0.0;
+        std::vector<int> bricks;     // Destroying any of these invalidates the prediction
+        bool aimedAtCentre = false;  // No aim reached a brick; depends on m_brickCentreX
+    };
+    
+    qreal choosePaddleX(const GameWorld &world, TrackedBall &tracked, qreal speed, qreal radius);
+    
+    std::vector<TrackedBall> m_balls;
+    std::vector<int> m_candidates;
+    quint32 m_brickLayoutId;
+    int m_activeBricks;
+    qreal m_brickCentreX;
+    qreal m_paddleWidth;
+};
+
+#endif
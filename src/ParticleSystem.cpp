@@ -0,0 +1,95 @@
+#include "ParticleSystem.h"
+#include <algorithm>
+
+ParticleSystem::ParticleSystem(int capacity)
+    : m_capacity(0), m_count(0)
+{
+    setCapacity(capacity);
+}
+
+void ParticleSystem::setCapacity(int capacity)
+{
+    m_capacity = std::max(0, capacity);
+    m_count = std::min(m_count, m_capacity);
+    
+    m_x.resize(m_capacity);
+    m_y.resize(m_capacity);
+    m_vx.resize(m_capacity);
+    m_vy.resize(m_capacity);
+    m_lifetime.resize(m_capacity);
+    m_maxLifetime.resize(m_capacity);
+    m_color.resize(m_capacity);
+}
+
+bool ParticleSystem::spawn(qreal x, qreal y, qreal vx, qreal vy, const QColor &color, qreal lifetime)
+{
+    if (m_count >= m_capacity || lifetime <= 0.0) {
+        return false;
+    }
+    
+    const int i = m_count++;
+    m_x[i] = x;
+    m_y[i] = y;
+    m_vx[i] = vx;
+    m_vy[i] = vy;
+    m_lifetime[i] = lifetime;
+    m_maxLifetime[i] = lifetime;
+    m_color[i] = color.rgb();
+    return true;
+}
+
+void ParticleSystem::update(qreal delta)
+{
+    const int count = m_count;
+    qreal *x = m_x.data();
+    qreal *y = m_y.data();
+    const qreal *vx = m_vx.data();
+    qreal *vy = m_vy.data();
+    qreal *lifetime = m_lifetime.data();
+    const qreal gravityStep = GRAVITY * delta;
+    
+    // Integrate every particle in one branch-free pass (vectorisable); the
+    // ones that die this step are removed below, so moving them is harmless
+    for (int i = 0; i < count; ++i) {
+        lifetime[i] -= delta;
+        x[i] += vx[i] * delta;
+        y[i] += vy[i] * delta;
+        vy[i] += gravityStep;
+    }
+    
+    // Swap-remove dead particles to keep the live range dense
+    int i = 0;
+    while (i < m_count) {
+        if (m_lifetime[i] > 0.0) {
+            ++i;
+            continue;
+        }
+        
+        const int last = --m_count;
+        m_x[i] = m_x[last];
+        m_y[i] = m_y[last];
+        m_vx[i] = m_vx[last];
+        m_vy[i] = m_vy[last];
+        m_lifetime[i] = m_lifetime[last];
+        m_maxLifetime[i] = m_maxLifetime[last];
+        m_color[i] = m_color[last];
+    }
+}
+
+QColor ParticleSystem::color(int index) const
+{
+    QColor c = QColor::fromRgb(m_color[index]);
+    c.setAlphaF(alpha(index));
+    return c;
+}
+
+qreal ParticleSystem::particleSize(int index) const
+{
+    qreal ratio = m_lifetime[index] / m_maxLifetime[index];
+    return 4.0 * ratio + 1.0;
+}
+
+qreal ParticleSystem::alpha(int index) const
+{
+    return std::max(0.0, m_lifetime[index] / m_maxLifetime[index]);
+}
@@ -0,0 +1,47 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include <QPointF>
+#include <QColor>
+#include <vector>
+
+// Fixed-capacity particle pool in structure-of-arrays form. Storage is sized
+// once by setCapacity(), spawns beyond the budget are dropped, and dead
+// particles are swap-removed, so bursts never reallocate mid-frame. Live
+// particles always occupy indices [0, size()).
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(int capacity = DEFAULT_CAPACITY);
+    
+    void setCapacity(int capacity);
+    int capacity() const { return m_capacity; }
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    void clear() { m_count = 0; }
+    
+    // Returns false if the pool is full and the particle was dropped
+    bool spawn(qreal x, qreal y, qreal vx, qreal vy, const QColor &color, qreal lifetime);
+    void update(qreal delta);
+    
+    QPointF position(int index) const { return QPointF(m_x[index], m_y[index]); }
+    QColor color(int index) const;
+    qreal particleSize(int index) const;
+    qreal alpha(int index) const;
+    
+    static constexpr int DEFAULT_CAPACITY = 2000;
+    static constexpr qreal GRAVITY = 500.0;
+
+private:
+    int m_capacity;
+    int m_count;
+    std::vector<qreal> m_x;
+    std::vector<qreal> m_y;
+    std::vector<qreal> m_vx;
+    std::vector<qreal> m_vy;
+    std::vector<qreal> m_lifetime;
+    std::vector<qreal> m_maxLifetime;
+    std::vector<QRgb> m_color;
+};
+
+#endif
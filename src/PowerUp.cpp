@@ -2,7 +2,7 @@
 
 PowerUp::PowerUp(qreal x, qreal y, PowerUpType type)
     : m_position(x, y), m_width(40.0), m_height(20.0), m_speed(100.0), 
-      m_type(type), m_active(true)
+      m_type(type)
 {
     switch (type) {
         case PowerUpType::BiggerPaddle:
@@ -20,6 +20,9 @@ PowerUp::PowerUp(qreal x, qreal y, PowerUpType type)
         case PowerUpType::ExtraLife:
             m_color = QColor(255, 100, 255);
             break;
+        case PowerUpType::MultiBall:
+            m_color = QColor(230, 230, 230);
+            break;
     }
 }
 
@@ -33,9 +36,9 @@ QRectF PowerUp::rect() const
     return QRectF(m_position.x(), m_position.y(), m_width, m_height);
 }
 
-QString PowerUp::name() const
+QString PowerUp::nameFor(PowerUpType type)
 {
-    switch (m_type) {
+    switch (type) {
         case PowerUpType::BiggerPaddle:
             return "Bigger Paddle";
         case PowerUpType::SmallerPaddle:
@@ -46,6 +49,8 @@ QString PowerUp::name() const
             return "Fast Ball";
         case PowerUpType::ExtraLife:
             return "Extra Life";
+        case PowerUpType::MultiBall:
+            return "Multi Ball";
     }
     return "";
 }
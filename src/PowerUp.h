@@ -11,22 +11,25 @@ enum class PowerUpType {
     SmallerPaddle,
     SlowBall,
     FastBall,
-    ExtraLife
+    ExtraLife,
+    MultiBall
 };
 
 class PowerUp
 {
 public:
-    PowerUp(qreal x, qreal y, PowerUpType type);
-
+    PowerUp(qreal x = 0.0, qreal y = 0.0, PowerUpType type = PowerUpType::BiggerPaddle);
+    
     void move(qreal delta);
-    bool isActive() const { return m_active; }
-    void setActive(bool active) { m_active = active; }
     
     QRectF rect() const;
     PowerUpType type() const { return m_type; }
     QColor color() const { return m_color; }
-    QString name() const;
+    QString name() const { return nameFor(m_type); }
+    
+    static QString nameFor(PowerUpType type);
+    
+    static constexpr int TYPE_COUNT = 6;
 
 private:
     QPointF m_position;
@@ -35,7 +38,6 @@ private:
     qreal m_speed;
     PowerUpType m_type;
     QColor m_color;
-    bool m_active;
 };
 
 #endif
@@ -0,0 +1,53 @@
+#include "PowerUpPool.h"
+
+PowerUpPool::PowerUpPool(int capacity)
+    : m_slots(qMax(0, capacity)), m_generation(m_slots.size(), 0), m_livePosition(m_slots.size(), -1)
+{
+    m_live.reserve(m_slots.size());
+    m_free.reserve(m_slots.size());
+    clear();
+}
+
+void PowerUpPool::clear()
+{
+    m_live.clear();
+    m_free.clear();
+    
+    // Lowest slots are handed out first
+    for (int slot = capacity() - 1; slot >= 0; --slot) {
+        m_free.push_back(slot);
+        m_livePosition[slot] = -1;
+    }
+}
+
+int PowerUpPool::spawn(qreal x, qreal y, PowerUpType type)
+{
+    if (m_free.empty()) {
+        return -1;
+    }
+    
+    const int slot = m_free.back();
+    m_free.pop_back();
+    
+    m_slots[slot] = PowerUp(x, y, type);
+    ++m_generation[slot];
+    m_livePosition[slot] = static_cast<int>(m_live.size());
+    m_live.push_back(slot);
+    return slot;
+}
+
+void PowerUpPool::despawn(int slot)
+{
+    const int position = m_livePosition[slot];
+    if (position < 0) {
+        return;
+    }
+    
+    const int last = m_live.back();
+    m_live[position] = last;
+    m_livePosition[last] = position;
+    m_live.pop_back();
+    
+    m_livePosition[slot] = -1;
+    m_free.push_back(slot);
+}
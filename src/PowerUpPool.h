@@ -0,0 +1,47 @@
+#ifndef POWERUPPOOL_H
+#define POWERUPPOOL_H
+
+#include <vector>
+#include "PowerUp.h"
+
+// Fixed-capacity store for falling power-ups. Every slot is allocated up
+// front; free slots sit on a stack and live ones in a dense list, so spawn
+// and despawn are O(1), loops only visit live power-ups and memory use does
+// not depend on how many have been dropped. Spawns beyond capacity are
+// dropped, as in ParticleSystem.
+//
+// A slot keeps its index for the power-up's whole life, so per-slot side
+// data (such as last tick's position) stays valid; generation() tells a
+// reused slot apart from its previous occupant.
+class PowerUpPool
+{
+public:
+    explicit PowerUpPool(int capacity = DEFAULT_CAPACITY);
+    
+    void clear();
+    int capacity() const { return static_cast<int>(m_slots.size()); }
+    int size() const { return static_cast<int>(m_live.size()); }
+    bool isEmpty() const { return m_live.empty(); }
+    
+    // Returns the slot, or -1 if the pool is full and the power-up was dropped
+    int spawn(qreal x, qreal y, PowerUpType type);
+    void despawn(int slot);
+    
+    // Slots of the live power-ups. Despawning moves the last entry into the
+    // freed position, so walk it backwards when despawning on the way.
+    const std::vector<int> &live() const { return m_live; }
+    PowerUp &at(int slot) { return m_slots[slot]; }
+    const PowerUp &at(int slot) const { return m_slots[slot]; }
+    quint32 generation(int slot) const { return m_generation[slot]; }
+    
+    static constexpr int DEFAULT_CAPACITY = 32;
+
+private:
+    std::vector<PowerUp> m_slots;
+    std::vector<quint32> m_generation;
+    std::vector<int> m_livePosition;  // Index into m_live per slot, -1 if free
+    std::vector<int> m_live;
+    std::vector<int> m_free;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "Profiler.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QCoreApplication>
+#include <QDebug>
+#include <algorithm>
+#include <map>
+
+Profiler &Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_enabled(true), m_frames(FRAME_HISTORY, 0), m_framesWritten(0)
+{
+    m_clock.start();
+}
+
+Profiler::ThreadLog &Profiler::threadLog()
+{
+    // Each thread registers its log once; after that recording only touches
+    // the thread's own log
+    thread_local ThreadLog *log = nullptr;
+    if (!log) {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        auto newLog = std::make_unique<ThreadLog>();
+        newLog->id = static_cast<int>(m_threads.size()) + 1;
+        newLog->name = QString("Thread %1").arg(newLog->id);
+        newLog->events.resize(EVENTS_PER_THREAD);
+        log = newLog.get();
+        m_threads.push_back(std::move(newLog));
+    }
+    return *log;
+}
+
+void Profiler::setThreadName(const QString &name)
+{
+    ThreadLog &log = threadLog();
+    std::lock_guard<std::mutex> lock(log.mutex);
+    log.name = name;
+}
+
+void Profiler::record(const char *name, qint64 start, qint64 duration)
+{
+    ThreadLog &log = threadLog();
+    std::lock_guard<std::mutex> lock(log.mutex);
+    log.events[log.written % EVENTS_PER_THREAD] = TraceEvent{name, start, duration};
+    log.written++;
+}
+
+void Profiler::recordFrame(qint64 duration)
+{
+    std::lock_guard<std::mutex> lock(m_framesMutex);
+    m_frames[m_framesWritten % FRAME_HISTORY] = duration;
+    m_framesWritten++;
+}
+
+Profiler::FrameStats Profiler::frameStats() const
+{
+    std::vector<qint64> frames;
+    {
+        std::lock_guard<std::mutex> lock(m_framesMutex);
+        const size_t count = std::min<quint64>(m_framesWritten, FRAME_HISTORY);
+        frames.assign(m_frames.begin(), m_frames.begin() + count);
+    }
+    
+    FrameStats stats;
+    stats.samples = static_cast<int>(frames.size());
+    stats.histogram.assign(HISTOGRAM_BUCKETS, 0);
+    if (frames.empty()) {
+        return stats;
+    }
+    
+    for (qint64 frame : frames) {
+        const int bucket = static_cast<int>(frame / 1e6 / HISTOGRAM_BUCKET_MS);
+        stats.histogram[std::min(bucket, HISTOGRAM_BUCKETS - 1)]++;
+    }
+    
+    std::sort(frames.begin(), frames.end());
+    auto percentile = [&](qreal p) {
+        const size_t index = std::min(frames.size() - 1, static_cast<size_t>(p * frames.size()));
+        return frames[index] / 1e6;
+    };
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    stats.worst = frames.back() / 1e6;
+    return stats;
+}
+
+std::vector<Profiler::SectionStats> Profiler::sectionStats(qint64 window) const
+{
+    struct Totals
+    {
+        int calls = 0;
+        qint64 total = 0;
+        qint64 max = 0;
+    };
+    
+    // Keyed by text rather than pointer: the same literal may have several
+    // addresses across translation units
+    std::map<QString, Totals> totals;
+    const qint64 since = now() - window;
+    
+    std::lock_guard<std::mutex> threadsLock(m_threadsMutex);
+    for (const auto &log : m_threads) {
+        std::lock_guard<std::mutex> lock(log->mutex);
+        const quint64 count = std::min<quint64>(log->written, EVENTS_PER_THREAD);
+        for (quint64 i = log->written - count; i < log->written; ++i) {
+            const TraceEvent &event = log->events[i % EVENTS_PER_THREAD];
+            if (event.start < since) continue;
+            
+            Totals &entry = totals[QString::fromLatin1(event.name)];
+            entry.calls++;
+            entry.total += event.duration;
+            entry.max = std::max(entry.max, event.duration);
+        }
+    }
+    
+    std::vector<SectionStats> sections;
+    for (const auto &entry : totals) {
+        SectionStats section;
+        section.name = entry.first;
+        section.calls = entry.second.calls;
+        section.meanMs = entry.second.total / 1e6 / entry.second.calls;
+        section.maxMs = entry.second.max / 1e6;
+        sections.push_back(section);
+    }
+    
+    std::sort(sections.begin(), sections.end(), [](const SectionStats &a, const SectionStats &b) {
+        return a.meanMs * a.calls > b.meanMs * b.calls;
+    });
+    return sections;
+}
+
+bool Profiler::exportChromeTrace(const QString &filePath) const
+{
+    QJsonArray events;
+    const qint64 pid = QCoreApplication::applicationPid();
+    
+    {
+        std::lock_guard<std::mutex> threadsLock(m_threadsMutex);
+        for (const auto &log : m_threads) {
+            std::lock_guard<std::mutex> lock(log->mutex);
+            
+            QJsonObject threadName;
+            threadName["name"] = "thread_name";
+            threadName["ph"] = "M";
+            threadName["pid"] = pid;
+            threadName["tid"] = log->id;
+            threadName["args"] = QJsonObject{{"name", log->name}};
+            events.append(threadName);
+            
+            // Timestamps and durations are in microseconds
+            const quint64 count = std::min<quint64>(log->written, EVENTS_PER_THREAD);
+            for (quint64 i = log->written - count; i < log->written; ++i) {
+                const TraceEvent &event = log->events[i % EVENTS_PER_THREAD];
+                QJsonObject object;
+                object["name"] = QString::fromLatin1(event.name);
+                object["ph"] = "X";
+                object["ts"] = event.start / 1000.0;
+                object["dur"] = event.duration / 1000.0;
+                object["pid"] = pid;
+                object["tid"] = log->id;
+                events.append(object);
+            }
+        }
+    }
+    
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write trace to" << filePath;
+        return false;
+    }
+    
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
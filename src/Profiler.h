@@ -0,0 +1,116 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Process-wide instrumentation. ScopedTimer records named spans into a
+// per-thread ring buffer (only the owning thread writes it, so recording is
+// an uncontended lock and a store); GUI frame times go into a separate
+// history used for percentiles. Everything can be exported as Chrome
+// trace-event JSON for chrome://tracing or Perfetto.
+class Profiler
+{
+public:
+    struct FrameStats
+    {
+        int samples = 0;
+        qreal p50 = 0.0;   // Milliseconds
+        qreal p95 = 0.0;
+        qreal p99 = 0.0;
+        qreal worst = 0.0;
+        std::vector<int> histogram;  // HISTOGRAM_BUCKET_MS wide, last bucket open-ended
+    };
+    
+    struct SectionStats
+    {
+        QString name;
+        int calls = 0;
+        qreal meanMs = 0.0;
+        qreal maxMs = 0.0;
+    };
+    
+    static Profiler &instance();
+    
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    
+    // Names the calling thread in exported traces
+    void setThreadName(const QString &name);
+    
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+    void record(const char *name, qint64 start, qint64 duration);
+    void recordFrame(qint64 duration);
+    
+    FrameStats frameStats() const;
+    // Per-section timings over the last window nanoseconds, slowest first
+    std::vector<SectionStats> sectionStats(qint64 window) const;
+    
+    bool exportChromeTrace(const QString &filePath) const;
+    
+    static constexpr int EVENTS_PER_THREAD = 1 << 16;
+    static constexpr int FRAME_HISTORY = 600;
+    static constexpr int HISTOGRAM_BUCKETS = 20;
+    static constexpr qreal HISTOGRAM_BUCKET_MS = 2.0;
+
+private:
+    Profiler();
+    
+    struct TraceEvent
+    {
+        const char *name;
+        qint64 start;
+        qint64 duration;
+    };
+    
+    struct ThreadLog
+    {
+        QString name;
+        int id = 0;
+        mutable std::mutex mutex;
+        std::vector<TraceEvent> events;  // Ring of EVENTS_PER_THREAD
+        quint64 written = 0;
+    };
+    
+    ThreadLog &threadLog();
+    
+    std::atomic<bool> m_enabled;
+    QElapsedTimer m_clock;
+    
+    mutable std::mutex m_threadsMutex;
+    std::vector<std::unique_ptr<ThreadLog>> m_threads;
+    
+    mutable std::mutex m_framesMutex;
+    std::vector<qint64> m_frames;  // Ring of FRAME_HISTORY
+    quint64 m_framesWritten;
+};
+
+// Times the enclosing scope under name, which must be a string literal
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(const char *name)
+        : m_name(name),
+          m_start(Profiler::instance().isEnabled() ? Profiler::instance().now() : -1) {}
+    
+    ~ScopedTimer()
+    {
+        if (m_start >= 0) {
+            Profiler &profiler = Profiler::instance();
+            profiler.record(m_name, m_start, profiler.now() - m_start);
+        }
+    }
+    
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <QtGlobal>
+
+// Small, fast xoshiro256** generator. Each subsystem owns its own instance
+// (gameplay drops, particle effects, screen shake), so streams never
+// disturb one another and none of them touches shared state: a gameplay
+// sequence depends only on its seed, however many particles were spawned.
+// Output is identical on every platform, unlike the <random> distributions.
+class Random
+{
+public:
+    explicit Random(quint64 seed = 0) { setSeed(seed); }
+    
+    // Independent stream derived from one seed, e.g. one per worker thread
+    Random(quint64 seed, quint64 stream) { setSeed(seed ^ (stream * 0xd1342543de82ef95ull)); }
+    
+    void setSeed(quint64 seed)
+    {
+        // Expand the seed with splitmix64 so similar seeds give unrelated
+        // states and the state is never all zero
+        for (quint64 &word : m_state) {
+            seed += 0x9e3779b97f4a7c15ull;
+            quint64 z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            word = z ^ (z >> 31);
+        }
+    }
+    
+    quint64 next()
+    {
+        const quint64 result = rotl(m_state[1] * 5, 7) * 9;
+        const quint64 t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+    
+    // Uniform in [0, bound) by multiply-shift; no division, and the bias is
+    // negligible for the small bounds used here
+    quint32 bounded(quint32 bound)
+    {
+        return static_cast<quint32>(((next() >> 32) * bound) >> 32);
+    }
+    
+    // Uniform in [0, 1) and [low, high)
+    qreal uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    qreal uniform(qreal low, qreal high) { return low + (high - low) * uniform(); }
+
+private:
+    static quint64 rotl(quint64 x, int k) { return (x << k) | (x >> (64 - k)); }
+    
+    quint64 m_state[4];
+};
+
+#endif
@@ -0,0 +1,302 @@
+#include "Replay.h"
+#include "Level.h"
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+const char MAGIC[4] = { 'A', 'R', 'K', 'R' };
+const quint8 FORMAT_VERSION = 3;  // 2: xoshiro drop stream, 3: pooled power-ups
+
+// LEB128: seven bits per byte, high bit set on all but the last
+void writeVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+bool readVarint(const QByteArray &data, int &pos, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= data.size()) {
+            return false;
+        }
+        const quint8 byte = static_cast<quint8>(data[pos++]);
+        value |= static_cast<quint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+Replay::Replay()
+    : m_seed(0), m_tickRate(0), m_endTick(0), m_finalHash(0), m_lastInput(0)
+{
+}
+
+void Replay::begin(quint32 seed, int tickRate)
+{
+    m_seed = seed;
+    m_tickRate = tickRate;
+    m_endTick = 0;
+    m_finalHash = 0;
+    m_lastInput = 0;
+    m_entries.clear();
+}
+
+void Replay::recordInput(quint64 tick, const PaddleInput &input)
+{
+    const quint32 bits = inputBits(input);
+    if (bits == m_lastInput) {
+        return;
+    }
+    m_lastInput = bits;
+    
+    // Several changes before the same tick collapse into the last one
+    if (!m_entries.empty() && m_entries.back().tick == tick &&
+        m_entries.back().type == Entry::Type::Input) {
+        m_entries.back().value = bits;
+        return;
+    }
+    
+    Entry entry;
+    entry.tick = tick;
+    entry.type = Entry::Type::Input;
+    entry.value = bits;
+    m_entries.push_back(entry);
+}
+
+void Replay::recordLevel(quint64 tick, int levelId)
+{
+    Entry entry;
+    entry.tick = tick;
+    entry.type = Entry::Type::LoadLevel;
+    entry.value = static_cast<quint32>(levelId);
+    m_entries.push_back(entry);
+}
+
+void Replay::recordResetRound(quint64 tick)
+{
+    Entry entry;
+    entry.tick = tick;
+    entry.type = Entry::Type::ResetRound;
+    m_entries.push_back(entry);
+}
+
+void Replay::finish(quint64 tick, quint64 stateHash)
+{
+    m_endTick = tick;
+    m_finalHash = stateHash;
+}
+
+std::vector<int> Replay::levelIds() const
+{
+    std::vector<int> ids;
+    for (const Entry &entry : m_entries) {
+        const int id = static_cast<int>(entry.value);
+        if (entry.type == Entry::Type::LoadLevel && std::find(ids.begin(), ids.end(), id) == ids.end()) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+QByteArray Replay::toBinary() const
+{
+    QByteArray out;
+    out.reserve(32 + static_cast<int>(m_entries.size()) * 3);
+    out.append(MAGIC, sizeof(MAGIC));
+    out.append(static_cast<char>(FORMAT_VERSION));
+    
+    writeVarint(out, m_seed);
+    writeVarint(out, static_cast<quint64>(m_tickRate));
+    writeVarint(out, m_endTick);
+    for (int i = 0; i < 8; ++i) {
+        out.append(static_cast<char>((m_finalHash >> (i * 8)) & 0xff));
+    }
+    
+    // Ticks are stored as deltas, so a typical entry is three bytes
+    writeVarint(out, m_entries.size());
+    quint64 tick = 0;
+    for (const Entry &entry : m_entries) {
+        writeVarint(out, entry.tick - tick);
+        out.append(static_cast<char>(entry.type));
+        writeVarint(out, entry.value);
+        tick = entry.tick;
+    }
+    
+    return out;
+}
+
+bool Replay::fromBinary(const QByteArray &data)
+{
+    if (data.size() < 5 || !data.startsWith(QByteArray(MAGIC, sizeof(MAGIC))) ||
+        static_cast<quint8>(data[4]) != FORMAT_VERSION) {
+        return false;
+    }
+    
+    int pos = 5;
+    quint64 seed = 0;
+    quint64 tickRate = 0;
+    quint64 endTick = 0;
+    if (!readVarint(data, pos, seed) || !readVarint(data, pos, tickRate) ||
+        !readVarint(data, pos, endTick) || pos + 8 > data.size() || tickRate == 0) {
+        return false;
+    }
+    
+    quint64 finalHash = 0;
+    for (int i = 0; i < 8; ++i) {
+        finalHash |= static_cast<quint64>(static_cast<quint8>(data[pos++])) << (i * 8);
+    }
+    
+    quint64 count = 0;
+    if (!readVarint(data, pos, count) || count > static_cast<quint64>(data.size())) {
+        return false;
+    }
+    
+    std::vector<Entry> entries(count);
+    quint64 tick = 0;
+    for (Entry &entry : entries) {
+        quint64 delta = 0;
+        quint64 value = 0;
+        if (!readVarint(data, pos, delta) || pos >= data.size()) {
+            return false;
+        }
+        const quint8 type = static_cast<quint8>(data[pos++]);
+        if (type > static_cast<quint8>(Entry::Type::ResetRound) || !readVarint(data, pos, value)) {
+            return false;
+        }
+        
+        tick += delta;
+        entry.tick = tick;
+        entry.type = static_cast<Entry::Type>(type);
+        entry.value = static_cast<quint32>(value);
+    }
+    
+    m_seed = static_cast<quint32>(seed);
+    m_tickRate = static_cast<int>(tickRate);
+    m_endTick = endTick;
+    m_finalHash = finalHash;
+    m_lastInput = 0;
+    m_entries = std::move(entries);
+    return true;
+}
+
+bool Replay::save(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write replay file:" << filePath << file.errorString();
+        return false;
+    }
+    
+    file.write(toBinary());
+    return true;
+}
+
+bool Replay::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open replay file:" << filePath << file.errorString();
+        return false;
+    }
+    
+    if (!fromBinary(file.readAll())) {
+        qWarning() << "Invalid replay file:" << filePath;
+        return false;
+    }
+    return true;
+}
+
+quint32 Replay::inputBits(const PaddleInput &input)
+{
+    return (input.left ? 1u : 0u) | (input.right ? 2u : 0u);
+}
+
+PaddleInput Replay::inputFromBits(quint32 bits)
+{
+    PaddleInput input;
+    input.left = bits & 1u;
+    input.right = bits & 2u;
+    return input;
+}
+
+ReplayPlayer::ReplayPlayer(std::shared_ptr<const Replay> replay, LevelLookup levels)
+    : m_replay(std::move(replay)), m_levels(std::move(levels)), m_next(0), m_finished(false)
+{
+}
+
+void ReplayPlayer::start(GameWorld &world)
+{
+    m_next = 0;
+    m_input = PaddleInput();
+    m_finished = false;
+    world.newGame(m_replay->seed());
+}
+
+bool ReplayPlayer::step(GameWorld &world)
+{
+    if (m_finished) {
+        return false;
+    }
+    
+    applyDueEntries(world);
+    
+    // Ticks stop while the world is not playing, so once every entry due at
+    // this tick has been applied a finished world can never move on
+    if (world.tick() >= m_replay->endTick() || world.state() != WorldState::Playing) {
+        m_finished = true;
+        return false;
+    }
+    
+    world.step(m_input);
+    return true;
+}
+
+quint64 ReplayPlayer::run(GameWorld &world)
+{
+    const quint64 first = world.tick();
+    while (step(world)) {
+    }
+    return world.tick() - first;
+}
+
+bool ReplayPlayer::matches(const GameWorld &world) const
+{
+    return m_finished && world.tick() == m_replay->endTick() &&
+           world.stateHash() == m_replay->finalHash();
+}
+
+void ReplayPlayer::applyDueEntries(GameWorld &world)
+{
+    const auto &entries = m_replay->entries();
+    while (m_next < entries.size() && entries[m_next].tick <= world.tick()) {
+        const Replay::Entry &entry = entries[m_next++];
+        switch (entry.type) {
+            case Replay::Entry::Type::Input:
+                m_input = Replay::inputFromBits(entry.value);
+                break;
+            
+            case Replay::Entry::Type::LoadLevel:
+                if (std::shared_ptr<const Level> level = m_levels(static_cast<int>(entry.value))) {
+                    world.loadLevel(*level);
+                } else {
+                    qWarning() << "Replay references unknown level" << entry.value;
+                }
+                break;
+            
+            case Replay::Entry::Type::ResetRound:
+                world.resetRound();
+                break;
+        }
+    }
+}
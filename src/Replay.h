@@ -0,0 +1,97 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <QByteArray>
+#include <QString>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "GameWorld.h"
+
+class Level;
+
+// A recorded game session: the seed and tick rate the world was started
+// with, followed by every change to its inputs keyed by the tick it was
+// applied before. Paddle input is only logged when it changes, so a whole
+// game is a few kilobytes. Feeding the log to a fresh GameWorld through
+// ReplayPlayer reproduces the session bit for bit.
+class Replay
+{
+public:
+    struct Entry
+    {
+        enum class Type : quint8 {
+            Input,
+            LoadLevel,
+            ResetRound
+        };
+        
+        quint64 tick = 0;
+        Type type = Type::Input;
+        quint32 value = 0;  // Input bits for Input, level id for LoadLevel
+    };
+    
+    Replay();
+    
+    // Recording; ticks must not decrease between calls
+    void begin(quint32 seed, int tickRate);
+    void recordInput(quint64 tick, const PaddleInput &input);
+    void recordLevel(quint64 tick, int levelId);
+    void recordResetRound(quint64 tick);
+    void finish(quint64 tick, quint64 stateHash);
+    
+    bool isValid() const { return m_tickRate > 0; }
+    quint32 seed() const { return m_seed; }
+    int tickRate() const { return m_tickRate; }
+    quint64 endTick() const { return m_endTick; }
+    quint64 finalHash() const { return m_finalHash; }
+    const std::vector<Entry> &entries() const { return m_entries; }
+    std::vector<int> levelIds() const;
+    
+    QByteArray toBinary() const;
+    bool fromBinary(const QByteArray &data);
+    bool save(const QString &filePath) const;
+    bool load(const QString &filePath);
+    
+    static quint32 inputBits(const PaddleInput &input);
+    static PaddleInput inputFromBits(quint32 bits);
+
+private:
+    quint32 m_seed;
+    int m_tickRate;
+    quint64 m_endTick;
+    quint64 m_finalHash;
+    quint32 m_lastInput;
+    std::vector<Entry> m_entries;
+};
+
+// Feeds a Replay back into a GameWorld one tick at a time. Levels are
+// resolved through the lookup, which is called on whatever thread steps the
+// player, so it should only capture immutable data.
+class ReplayPlayer
+{
+public:
+    using LevelLookup = std::function<std::shared_ptr<const Level>(int levelId)>;
+    
+    ReplayPlayer(std::shared_ptr<const Replay> replay, LevelLookup levels);
+    
+    void start(GameWorld &world);
+    bool step(GameWorld &world);  // Returns false once the replay has finished
+    quint64 run(GameWorld &world);  // Headless: steps to the end, returns ticks played
+    
+    bool isFinished() const { return m_finished; }
+    // True if the world ended in exactly the recorded state
+    bool matches(const GameWorld &world) const;
+    const Replay &replay() const { return *m_replay; }
+
+private:
+    void applyDueEntries(GameWorld &world);
+    
+    std::shared_ptr<const Replay> m_replay;
+    LevelLookup m_levels;
+    size_t m_next;
+    PaddleInput m_input;
+    bool m_finished;
+};
+
+#endif
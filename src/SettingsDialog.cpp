@@ -110,7 +110,40 @@ void SettingsDialog::createGraphicsTab()
     m_vsyncCheck = new QCheckBox("Enable VSync");
     displayLayout->addWidget(m_vsyncCheck);
     
+    QHBoxLayout *frameRateLayout = new QHBoxLayout();
+    frameRateLayout->addWidget(new QLabel("Frame rate cap:"));
+    m_frameRateCapCombo = new QComboBox();
+    for (int cap : {30, 60, 120, 144}) {
+        m_frameRateCapCombo->addItem(QString("%1 FPS").arg(cap), cap);
+    }
+    m_frameRateCapCombo->addItem("Uncapped", 0);
+    frameRateLayout->addWidget(m_frameRateCapCombo);
+    frameRateLayout->addStretch();
+    displayLayout->addLayout(frameRateLayout);
+    
     layout->addWidget(displayGroup);
+    
+    QGroupBox *effectsGroup = new QGroupBox("Effects");
+    QVBoxLayout *effectsLayout = new QVBoxLayout(effectsGroup);
+    
+    QHBoxLayout *particleLayout = new QHBoxLayout();
+    particleLayout->addWidget(new QLabel("Particle budget:"));
+    m_particleBudgetSpin = new QSpinBox();
+    m_particleBudgetSpin->setRange(0, 20000);
+    m_particleBudgetSpin->setSingleStep(500);
+    particleLayout->addWidget(m_particleBudgetSpin);
+    particleLayout->addStretch();
+    effectsLayout->addLayout(particleLayout);
+    
+    QHBoxLayout *trailLayout = new QHBoxLayout();
+    trailLayout->addWidget(new QLabel("Ball trail length:"));
+    m_trailLengthSpin = new QSpinBox();
+    m_trailLengthSpin->setRange(0, 60);
+    trailLayout->addWidget(m_trailLengthSpin);
+    trailLayout->addStretch();
+    effectsLayout->addLayout(trailLayout);
+    
+    layout->addWidget(effectsGroup);
     layout->addStretch();
     
     m_tabWidget->addTab(graphicsTab, "Graphics");
@@ -161,6 +194,10 @@ void SettingsDialog::loadSettings()
     
     m_fullscreenCheck->setChecked(m_settings.value("graphics/fullscreen", false).toBool());
     m_vsyncCheck->setChecked(m_settings.value("graphics/vsync", true).toBool());
+    int capIndex = m_frameRateCapCombo->findData(m_settings.value("graphics/frameRateCap", 60).toInt());
+    m_frameRateCapCombo->setCurrentIndex(capIndex >= 0 ? capIndex : 1);
+    m_particleBudgetSpin->setValue(m_settings.value("graphics/particleBudget", 2000).toInt());
+    m_trailLengthSpin->setValue(m_settings.value("graphics/trailLength", 10).toInt());
     
     QString leftKey = m_settings.value("controls/leftKey", "A").toString();
     m_leftKeyCombo->setCurrentText(leftKey);
@@ -178,6 +215,9 @@ void SettingsDialog::saveSettings()
     
     m_settings.setValue("graphics/fullscreen", m_fullscreenCheck->isChecked());
     m_settings.setValue("graphics/vsync", m_vsyncCheck->isChecked());
+    m_settings.setValue("graphics/frameRateCap", frameRateCap());
+    m_settings.setValue("graphics/particleBudget", m_particleBudgetSpin->value());
+    m_settings.setValue("graphics/trailLength", m_trailLengthSpin->value());
     
     m_settings.setValue("controls/leftKey", m_leftKeyCombo->currentText());
     m_settings.setValue("controls/rightKey", m_rightKeyCombo->currentText());
@@ -228,6 +268,21 @@ bool SettingsDialog::isVsyncEnabled() const
     return m_vsyncCheck->isChecked();
 }
 
+int SettingsDialog::frameRateCap() const
+{
+    return m_frameRateCapCombo->currentData().toInt();
+}
+
+int SettingsDialog::particleBudget() const
+{
+    return m_particleBudgetSpin->value();
+}
+
+int SettingsDialog::trailLength() const
+{
+    return m_trailLengthSpin->value();
+}
+
 QString SettingsDialog::leftKey() const
 {
     return m_leftKeyCombo->currentText();
@@ -6,6 +6,7 @@
 #include <QCheckBox>
 #include <QSlider>
 #include <QComboBox>
+#include <QSpinBox>
 #include <QSettings>
 
 class SettingsDialog : public QDialog
@@ -22,6 +23,9 @@ public:
     int soundVolume() const;
     bool isFullscreen() const;
     bool isVsyncEnabled() const;
+    int frameRateCap() const;  // 0 = uncapped
+    int particleBudget() const;
+    int trailLength() const;
     QString leftKey() const;
     QString rightKey() const;
     
@@ -51,6 +55,9 @@ private:
     // Graphics settings
     QCheckBox *m_fullscreenCheck;
     QCheckBox *m_vsyncCheck;
+    QComboBox *m_frameRateCapCombo;
+    QSpinBox *m_particleBudgetSpin;
+    QSpinBox *m_trailLengthSpin;
     
     // Controls settings
     QComboBox *m_leftKeyCombo;
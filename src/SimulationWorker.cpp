@@ -0,0 +1,369 @@
+#include "SimulationWorker.h"
+#include "Level.h"
+#include "Profiler.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+SimulationWorker::SimulationWorker(int tickRate)
+    : m_world(tickRate), m_playbackSpeed(1.0), m_paused(false), m_accumulator(0.0), m_lastAdvance(0),
+      m_timer(nullptr)
+{
+    m_clock.start();
+    captureRenderState();
+}
+
+bool SimulationWorker::post(const WorldCommand &command)
+{
+    return m_commands.push(command);
+}
+
+bool SimulationWorker::takeEvent(GameEvent &event)
+{
+    return m_events.pop(event);
+}
+
+bool SimulationWorker::updateFrame()
+{
+    return m_frames.update();
+}
+
+void SimulationWorker::start()
+{
+    Profiler::instance().setThreadName("Simulation");
+    
+    // Created here so the timer lives on the simulation thread; waking every
+    // half tick keeps the latency between a tick coming due and running it low
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &SimulationWorker::advance);
+    m_timer->start(qMax(1, static_cast<int>(m_world.tickTime() * 500.0)));
+    
+    m_lastAdvance = now();
+    processCommands();
+    publishFrame(m_lastAdvance);
+}
+
+void SimulationWorker::advance()
+{
+    const qint64 time = now();
+    const qreal delta = std::min((time - m_lastAdvance) / 1e9, MAX_FRAME_DELTA);
+    m_lastAdvance = time;
+    
+    bool changed = false;
+    {
+        ScopedTimer timer("Commands");
+        changed = processCommands();
+    }
+    
+    if (!m_paused) {
+        // Replays may run faster than real time
+        const qreal scaledDelta = m_player ? delta * m_playbackSpeed : delta;
+        m_accumulator += scaledDelta;
+        while (m_accumulator >= m_world.tickTime()) {
+            captureRenderState();
+            if (!stepWorld()) {
+                m_accumulator = 0.0;
+                break;
+            }
+            m_accumulator -= m_world.tickTime();
+            changed = true;
+        }
+        
+        m_world.takeEvents(m_tickEvents);
+        m_pendingEvents.insert(m_pendingEvents.end(), m_tickEvents.begin(), m_tickEvents.end());
+        
+        ScopedTimer timer("Particles");
+        spawnEffects(m_tickEvents);
+        changed = changed || !m_particles.isEmpty();
+        m_particles.update(scaledDelta);
+    }
+    
+    // Publish before handing out the events, so by the time the GUI sees an
+    // event the frame showing its outcome is already available
+    if (changed) {
+        publishFrame(time);
+    }
+    flushEvents();
+}
+
+bool SimulationWorker::processCommands()
+{
+    bool changed = false;
+    WorldCommand command;
+    
+    while (m_commands.pop(command)) {
+        switch (command.type) {
+            case WorldCommand::Type::SetInput:
+                if (m_controller) {
+                    break;
+                }
+                m_input = command.input;
+                if (!m_player) {
+                    m_recording.recordInput(m_world.tick(), m_input);
+                }
+                break;
+                
+            case WorldCommand::Type::NewGame:
+                m_player.reset();
+                m_world.newGame(command.seed);
+                m_effectRandom = Random(command.seed, EFFECT_STREAM);
+                if (m_controller) {
+                    m_controller->reset();
+                }
+                m_recording.begin(command.seed, m_world.tickRate());
+                m_recording.recordInput(m_world.tick(), m_input);
+                break;
+                
+            case WorldCommand::Type::LoadLevel:
+                if (command.level) {
+                    if (command.layout) {
+                        m_world.loadLayout(std::move(*command.layout));
+                    } else {
+                        m_world.loadLevel(*command.level);
+                    }
+                    if (!m_player) {
+                        m_recording.recordLevel(m_world.tick(), command.levelId);
+                    }
+                }
+                break;
+                
+            case WorldCommand::Type::ResetRound:
+                m_world.resetRound();
+                if (!m_player) {
+                    m_recording.recordResetRound(m_world.tick());
+                }
+                break;
+                
+            case WorldCommand::Type::SetPaused:
+                m_paused = command.paused;
+                break;
+                
+            case WorldCommand::Type::SetParticleBudget:
+                m_particles.setCapacity(command.particleBudget);
+                break;
+                
+            case WorldCommand::Type::PlayReplay:
+                if (!command.replay) {
+                    break;
+                }
+                if (command.replay->replay().tickRate() != m_world.tickRate()) {
+                    qWarning() << "Replay was recorded at" << command.replay->replay().tickRate()
+                               << "ticks per second, the simulation runs at" << m_world.tickRate();
+                    break;
+                }
+                // Close off the game being recorded before the replay takes over the world
+                if (!m_player) {
+                    m_recording.finish(m_world.tick(), m_world.stateHash());
+                }
+                m_player = command.replay;
+                m_playbackSpeed = command.playbackSpeed;
+                m_player->start(m_world);
+                m_effectRandom = Random(m_player->replay().seed(), EFFECT_STREAM);
+                break;
+                
+            case WorldCommand::Type::SetAutopilot:
+                if (command.autopilot && !m_controller) {
+                    m_controller = std::make_unique<Autopilot>();
+                } else if (!command.autopilot && m_controller) {
+                    // Hand back a still paddle; the scene resends any keys
+                    // that are held
+                    m_controller.reset();
+                    m_input = PaddleInput();
+                    if (!m_player) {
+                        m_recording.recordInput(m_world.tick(), m_input);
+                    }
+                }
+                break;
+        }
+        
+        // World resets start from a clean slate with nothing to interpolate
+        if (command.type == WorldCommand::Type::NewGame ||
+            command.type == WorldCommand::Type::LoadLevel ||
+            command.type == WorldCommand::Type::ResetRound ||
+            command.type == WorldCommand::Type::PlayReplay) {
+            m_accumulator = 0.0;
+            m_particles.clear();
+            m_pendingEvents.clear();
+            captureRenderState();
+        }
+        
+        changed = true;
+        command.level.reset();
+        command.replay.reset();
+    }
+    
+    return changed;
+}
+
+bool SimulationWorker::stepWorld()
+{
+    if (!m_player) {
+        // The controller's input is recorded like the player's, so an
+        // autopilot game replays without it
+        if (m_controller) {
+            m_input = m_controller->update(m_world);
+            m_recording.recordInput(m_world.tick(), m_input);
+        }
+        m_world.step(m_input);
+        return true;
+    }
+    
+    if (m_player->isFinished()) {
+        return false;
+    }
+    
+    if (!m_player->step(m_world)) {
+        if (m_player->matches(m_world)) {
+            qDebug() << "Replay finished at tick" << m_world.tick() << "in the recorded state";
+        } else {
+            qWarning() << "Replay diverged from the recording: ended at tick" << m_world.tick()
+                       << "of" << m_player->replay().endTick();
+        }
+        return false;
+    }
+    return true;
+}
+
+Replay SimulationWorker::recordedReplay() const
+{
+    Replay replay = m_recording;
+    if (!m_player) {
+        replay.finish(m_world.tick(), m_world.stateHash());
+    }
+    return replay;
+}
+
+void SimulationWorker::captureRenderState()
+{
+    m_previousPaddleRect = m_world.paddle().rect();
+    
+    const BallArray &balls = m_world.balls();
+    m_previousBallPositions.resize(balls.size());
+    for (int i = 0; i < balls.size(); ++i) {
+        m_previousBallPositions[i] = balls.position(i);
+    }
+    
+    const PowerUpPool &powerUps = m_world.powerUps();
+    m_previousPowerUps.resize(powerUps.capacity());
+    for (int slot : powerUps.live()) {
+        m_previousPowerUps[slot] = { powerUps.at(slot).rect().topLeft(), powerUps.generation(slot) };
+    }
+}
+
+void SimulationWorker::spawnEffects(const std::vector<GameEvent> &events)
+{
+    for (const GameEvent &event : events) {
+        switch (event.type) {
+            case GameEvent::Type::BrickHit:
+                // Smaller effect for damage
+                spawnParticles(event.position.x(), event.position.y(), event.color, 5);
+                break;
+                
+            case GameEvent::Type::BrickDestroyed:
+                spawnParticles(event.position.x(), event.position.y(), event.color, 15);
+                break;
+                
+            case GameEvent::Type::PowerUpCollected:
+                spawnParticles(event.position.x(), event.position.y(), event.color, 10);
+                break;
+                
+            default:
+                break;
+        }
+    }
+}
+
+void SimulationWorker::spawnParticles(qreal x, qreal y, const QColor &color, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        qreal angle = m_effectRandom.uniform(0.0, 2.0 * M_PI);
+        qreal speed = m_effectRandom.uniform(100.0, 300.0);
+        qreal vx = std::cos(angle) * speed;
+        qreal vy = std::sin(angle) * speed - 100.0;
+        qreal lifetime = m_effectRandom.uniform(0.5, 1.5);
+        
+        if (!m_particles.spawn(x, y, vx, vy, color, lifetime)) {
+            break;  // Particle budget exhausted
+        }
+    }
+}
+
+void SimulationWorker::publishFrame(qint64 publishedAt)
+{
+    ScopedTimer timer("Publish frame");
+    
+    // Assigning into the reused slot keeps vector capacity between frames
+    FrameSnapshot &frame = m_frames.writeBuffer();
+    
+    frame.tick = m_world.tick();
+    frame.publishedAt = publishedAt;
+    frame.tickTime = m_world.tickTime();
+    frame.accumulator = m_accumulator;
+    frame.running = !m_paused && m_world.state() == WorldState::Playing;
+    
+    frame.state = m_world.state();
+    frame.score = m_world.score();
+    frame.lives = m_world.lives();
+    frame.invulnerable = m_world.isInvulnerable();
+    frame.invulnerabilityTimer = m_world.invulnerabilityTimer();
+    
+    frame.paddleRect = m_world.paddle().rect();
+    frame.previousPaddleRect = m_previousPaddleRect;
+    
+    const BallArray &balls = m_world.balls();
+    frame.ballPositions.resize(balls.size());
+    frame.ballRadii.resize(balls.size());
+    for (int i = 0; i < balls.size(); ++i) {
+        frame.ballPositions[i] = balls.position(i);
+        frame.ballRadii[i] = balls.radius(i);
+    }
+    
+    // Balls are swap-removed and split, so indices only line up while the
+    // count is unchanged
+    if (m_previousBallPositions.size() == frame.ballPositions.size()) {
+        frame.previousBallPositions = m_previousBallPositions;
+    } else {
+        frame.previousBallPositions.clear();
+    }
+    
+    // Slots are stable while a power-up lives; a slot reused this tick has
+    // no previous position to interpolate from
+    const PowerUpPool &powerUps = m_world.powerUps();
+    frame.powerUps.clear();
+    for (int slot : powerUps.live()) {
+        const PowerUp &powerUp = powerUps.at(slot);
+        
+        FrameSnapshot::PowerUpSprite sprite;
+        sprite.rect = powerUp.rect();
+        const bool tracked = slot < static_cast<int>(m_previousPowerUps.size()) &&
+                             m_previousPowerUps[slot].generation == powerUps.generation(slot);
+        sprite.previousTopLeft = tracked ? m_previousPowerUps[slot].topLeft : sprite.rect.topLeft();
+        sprite.type = powerUp.type();
+        sprite.color = powerUp.color();
+        frame.powerUps.push_back(sprite);
+    }
+    
+    frame.bricks = m_world.bricks();
+    frame.brickLayoutId = m_world.brickLayoutId();
+    
+    frame.particles.resize(m_particles.size());
+    for (int i = 0; i < m_particles.size(); ++i) {
+        FrameSnapshot::ParticleSprite &particle = frame.particles[i];
+        particle.position = m_particles.position(i);
+        particle.color = m_particles.color(i).rgba();
+        particle.size = m_particles.particleSize(i);
+    }
+    
+    m_frames.publish();
+}
+
+void SimulationWorker::flushEvents()
+{
+    // Events are never dropped; whatever doesn't fit waits for the next advance
+    size_t sent = 0;
+    while (sent < m_pendingEvents.size() && m_events.push(m_pendingEvents[sent])) {
+        ++sent;
+    }
+    m_pendingEvents.erase(m_pendingEvents.begin(), m_pendingEvents.begin() + sent);
+}
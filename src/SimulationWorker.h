@@ -0,0 +1,124 @@
+#ifndef SIMULATIONWORKER_H
+#define SIMULATIONWORKER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <memory>
+#include <vector>
+#include "GameWorld.h"
+#include "ParticleSystem.h"
+#include "FrameSnapshot.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+#include "Replay.h"
+#include "Random.h"
+#include "PaddleController.h"
+
+class Level;
+
+// Requests from the GUI thread to the simulation
+struct WorldCommand
+{
+    enum class Type {
+        SetInput,
+        NewGame,
+        LoadLevel,
+        ResetRound,
+        SetPaused,
+        SetParticleBudget,
+        PlayReplay,
+        SetAutopilot
+    };
+    
+    Type type = Type::SetInput;
+    PaddleInput input;
+    bool paused = false;
+    bool autopilot = false;
+    int particleBudget = 0;
+    quint32 seed = 0;  // NewGame
+    int levelId = 0;   // LoadLevel, as recorded in replays
+    std::shared_ptr<const Level> level;
+    std::shared_ptr<LevelLayout> layout;  // LoadLevel: prebuilt from level, moved into the world
+    std::shared_ptr<ReplayPlayer> replay;
+    qreal playbackSpeed = 1.0;
+};
+
+// Runs GameWorld and the particle effects on whatever thread it is moved to.
+// The GUI thread talks to it only through wait-free queues (commands in,
+// events out) and reads frames from a triple buffer, so neither side ever
+// blocks on the other: a modal dialog or a slow paint no longer stalls the
+// game, and a slow tick never stalls painting.
+class SimulationWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SimulationWorker(int tickRate = GameWorld::DEFAULT_TICK_RATE);
+    
+    // GUI thread side. post() returns false if the command queue is full.
+    bool post(const WorldCommand &command);
+    bool takeEvent(GameEvent &event);
+    bool updateFrame();  // Returns true if a newer frame was picked up
+    const FrameSnapshot &frame() const { return m_frames.readBuffer(); }
+    
+    // Monotonic clock shared by both threads, in nanoseconds
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+    
+    // Every game started with NewGame is recorded until the next one.
+    // Simulation thread only; the GUI reaches it through a blocking
+    // queued invocation.
+    Replay recordedReplay() const;
+    
+    static constexpr qreal MAX_FRAME_DELTA = 0.25;
+    // Effects draw from their own stream of the game seed, apart from the
+    // world's drops, so a replay looks the same as the game it recorded
+    static constexpr quint64 EFFECT_STREAM = 1;
+
+public slots:
+    void start();
+
+private slots:
+    void advance();
+
+private:
+    bool processCommands();
+    void captureRenderState();
+    void spawnEffects(const std::vector<GameEvent> &events);
+    void spawnParticles(qreal x, qreal y, const QColor &color, int count);
+    void publishFrame(qint64 publishedAt);
+    void flushEvents();
+    bool stepWorld();  // False once a finished replay holds the world still
+    
+    GameWorld m_world;
+    ParticleSystem m_particles;
+    Random m_effectRandom;
+    PaddleInput m_input;
+    std::unique_ptr<PaddleController> m_controller;  // Overrides SetInput while set
+    Replay m_recording;
+    std::shared_ptr<ReplayPlayer> m_player;  // Set while a replay drives the world
+    qreal m_playbackSpeed;
+    bool m_paused;
+    qreal m_accumulator;
+    qint64 m_lastAdvance;
+    QElapsedTimer m_clock;
+    QTimer *m_timer;
+    
+    std::vector<GameEvent> m_tickEvents;
+    std::vector<GameEvent> m_pendingEvents;  // Waiting for room in m_events
+    QRectF m_previousPaddleRect;
+    std::vector<QPointF> m_previousBallPositions;
+    
+    struct PreviousPowerUp
+    {
+        QPointF topLeft;
+        quint32 generation = 0;
+    };
+    std::vector<PreviousPowerUp> m_previousPowerUps;  // Indexed by pool slot
+    
+    SpscQueue<WorldCommand, 256> m_commands;
+    SpscQueue<GameEvent, 1024> m_events;
+    TripleBuffer<FrameSnapshot> m_frames;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Lock-free handoff of whole values from one writer thread to one reader
+// thread. The writer fills writeBuffer() and publishes it; the reader picks
+// up the newest published value with update() and reads it from
+// readBuffer(). Neither side ever waits and intermediate values the reader
+// was too slow to see are simply skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Writer side
+    T &writeBuffer() { return m_slots[m_back]; }
+    
+    void publish()
+    {
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    
+    // Reader side; returns true if a newer value was taken
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    
+    const T &readBuffer() const { return m_slots[m_front]; }
+
+private:
+    static constexpr quint8 INDEX_MASK = 0x3;
+    static constexpr quint8 FRESH = 0x4;  // Middle slot holds an unread value
+    
+    T m_slots[3];
+    quint8 m_back = 0;                 // Owned by the writer
+    quint8 m_front = 2;                // Owned by the reader
+    std::atomic<quint8> m_middle{1};   // Shared: slot index plus FRESH flag
+};
+
+#endif
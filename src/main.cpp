@@ -1,12 +1,50 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <cstdio>
 #include "Game.h"
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Qt Arkanoid. Frames can be captured without a display by running "
+                                     "with QT_QPA_PLATFORM=offscreen.");
+    parser.addHelpOption();
+    QCommandLineOption autopilotOption("autopilot", "Let the autopilot play.");
+    QCommandLineOption replayOption("replay", "Play the replay in <file>.", "file");
+    QCommandLineOption captureOption("capture", "Write every frame to <dir>.", "dir");
+    QCommandLineOption formatOption("capture-format", "Frame format: png or qoi.", "format", "png");
+    QCommandLineOption framesOption("capture-frames", "Quit after capturing <count> frames.", "count", "0");
+    parser.addOptions({ autopilotOption, replayOption, captureOption, formatOption, framesOption });
+    parser.process(app);
+
+    bool formatOk = false;
+    const FrameCapture::Format format = FrameCapture::formatFromName(parser.value(formatOption), &formatOk);
+    if (!formatOk) {
+        std::fprintf(stderr, "Unknown capture format '%s'\n", qPrintable(parser.value(formatOption)));
+        return 1;
+    }
+
     Game game;
     game.show();
 
+    if (parser.isSet(autopilotOption)) {
+        game.setAutopilot(true);
+    }
+    if (parser.isSet(replayOption) && !game.playReplay(parser.value(replayOption))) {
+        std::fprintf(stderr, "Could not play %s\n", qPrintable(parser.value(replayOption)));
+        return 1;
+    }
+    if (parser.isSet(captureOption)) {
+        const int frames = parser.value(framesOption).toInt();
+        if (!game.startCapture(parser.value(captureOption), format, frames)) {
+            return 1;
+        }
+        if (frames > 0) {
+            QObject::connect(&game, &Game::captureFinished, &app, &QApplication::quit);
+        }
+    }
+
     return app.exec();
 }
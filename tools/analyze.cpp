@@ -0,0 +1,186 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "HeadlessGame.h"
+#include "Level.h"
+#include "LevelManager.h"
+#include "PaddleController.h"
+#include "Profiler.h"
+
+namespace {
+
+struct Job
+{
+    int level;  // Index into the analysed levels
+    quint32 seed;
+};
+
+template <typename T>
+T percentile(std::vector<T> values, double fraction)
+{
+    if (values.empty()) {
+        return T();
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+}
+
+} // namespace
+
+// Estimates how hard each level is by playing it many times from a fresh
+// game with the autopilot, every run with its own seed, spread over all
+// cores. Reports how often a level is cleared, how long that takes in game
+// time, how many lives it costs and which power-ups it hands out.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures Qt Arkanoid level difficulty by simulation");
+    parser.addHelpOption();
+    QCommandLineOption runsOption({ "n", "runs" }, "Runs per level.", "count", "1000");
+    QCommandLineOption threadsOption({ "t", "threads" }, "Worker threads (default: one per core).", "count",
+                                     QString::number(QThread::idealThreadCount()));
+    QCommandLineOption seedOption("seed", "Seed of the first run; run i uses seed + i on every level.", "seed", "1");
+    QCommandLineOption minutesOption("max-minutes", "Game-time limit per run in minutes.", "minutes", "10");
+    QCommandLineOption levelOption("level", "Only analyse level <id> (repeatable).", "id");
+    QCommandLineOption packOption("pack", "Also load the user level pack in <dir>.", "dir");
+    QCommandLineOption controllerOption("controller", "Paddle controller: autopilot or follow.", "name", "autopilot");
+    parser.addOptions({ runsOption, threadsOption, seedOption, minutesOption, levelOption, packOption,
+                        controllerOption });
+    parser.process(app);
+    
+    const QString controller = parser.value(controllerOption);
+    if (controller != "autopilot" && controller != "follow") {
+        std::fprintf(stderr, "analyze: unknown controller '%s'\n", qPrintable(controller));
+        return 1;
+    }
+    
+    // Only the report goes to stdout
+    QLoggingCategory::setFilterRules("default.debug=false");
+    Profiler::instance().setEnabled(false);
+    
+    LevelManager levelManager;
+    for (const QString &pack : parser.values(packOption)) {
+        levelManager.addPackDirectory(pack);
+    }
+    if (!levelManager.loadLevels()) {
+        std::fprintf(stderr, "analyze: no levels found\n");
+        return 1;
+    }
+    
+    std::vector<int> ids;
+    for (const QString &value : parser.values(levelOption)) {
+        const int id = value.toInt();
+        if (id < 1 || id > levelManager.totalLevels()) {
+            std::fprintf(stderr, "analyze: no level %s\n", qPrintable(value));
+            return 1;
+        }
+        ids.push_back(id);
+    }
+    if (ids.empty()) {
+        for (int id = 1; id <= levelManager.totalLevels(); ++id) {
+            ids.push_back(id);
+        }
+    }
+    
+    std::vector<std::shared_ptr<const Level>> levels;
+    for (int id : ids) {
+        std::shared_ptr<const Level> level = levelManager.level(id);
+        if (!level) {
+            std::fprintf(stderr, "analyze: could not load level %d\n", id);
+            return 1;
+        }
+        levels.push_back(level);
+    }
+    
+    const int runs = qMax(1, parser.value(runsOption).toInt());
+    const int threads = qMax(1, parser.value(threadsOption).toInt());
+    const quint32 firstSeed = parser.value(seedOption).toUInt();
+    const quint64 maxTicks = static_cast<quint64>(parser.value(minutesOption).toDouble() * 60.0 *
+                                                  GameWorld::DEFAULT_TICK_RATE);
+    
+    // One flat job list so a slow level does not leave cores idle. Every
+    // level sees the same seeds, which keeps the comparison between levels
+    // down to the levels themselves.
+    std::vector<Job> jobs;
+    jobs.reserve(levels.size() * runs);
+    for (int level = 0; level < static_cast<int>(levels.size()); ++level) {
+        for (int run = 0; run < runs; ++run) {
+            jobs.push_back({ level, firstSeed + static_cast<quint32>(run) });
+        }
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    QElapsedTimer timer;
+    timer.start();
+    const QList<GameResult> results = QtConcurrent::blockingMapped<QList<GameResult>>(
+        &pool, jobs, [&](const Job &job) {
+            std::unique_ptr<PaddleController> paddle;
+            if (controller == "follow") {
+                paddle = std::make_unique<BallFollower>();
+            } else {
+                paddle = std::make_unique<Autopilot>();
+            }
+            HeadlessGame game({ levels[job.level] }, [&paddle](const GameWorld &world) {
+                return paddle->update(world);
+            });
+            game.setMaxTicks(maxTicks);
+            return game.play(job.seed);
+        });
+    const double seconds = qMax<qint64>(timer.nsecsElapsed(), 1) / 1e9;
+    
+    std::printf("analyze: %d levels x %d runs, %d threads, %s, %.2f s\n", static_cast<int>(levels.size()), runs,
+                threads, qPrintable(controller), seconds);
+    
+    for (int level = 0; level < static_cast<int>(levels.size()); ++level) {
+        int outcomes[3] = { 0, 0, 0 };
+        int livesLost[4] = { 0, 0, 0, 0 };  // 0, 1, 2, 3 or more
+        int totalLivesLost = 0;
+        int powerUps[PowerUp::TYPE_COUNT] = {};
+        std::vector<double> clearSeconds;
+        
+        for (int run = 0; run < runs; ++run) {
+            const GameResult &result = results[level * runs + run];
+            const LevelResult &played = result.levels.front();
+            ++outcomes[static_cast<int>(result.outcome)];
+            ++livesLost[qMin(played.livesLost, 3)];
+            totalLivesLost += played.livesLost;
+            for (int type = 0; type < PowerUp::TYPE_COUNT; ++type) {
+                powerUps[type] += played.powerUps[type];
+            }
+            if (played.cleared) {
+                clearSeconds.push_back(static_cast<double>(played.ticks) / GameWorld::DEFAULT_TICK_RATE);
+            }
+        }
+        
+        auto share = [runs](int count) { return 100.0 * count / runs; };
+        std::printf("\nlevel %d \"%s\"\n", ids[level], qPrintable(levels[level]->name()));
+        std::printf("  cleared %.1f%%, lost %.1f%%, timed out %.1f%%\n",
+                    share(outcomes[0]), share(outcomes[1]), share(outcomes[2]));
+        if (!clearSeconds.empty()) {
+            std::printf("  clear time (game-time s): p10 %.1f, p50 %.1f, p90 %.1f, max %.1f\n",
+                        percentile(clearSeconds, 0.1), percentile(clearSeconds, 0.5),
+                        percentile(clearSeconds, 0.9), percentile(clearSeconds, 1.0));
+        }
+        std::printf("  lives lost: mean %.2f; 0: %.1f%%, 1: %.1f%%, 2: %.1f%%, 3+: %.1f%%\n",
+                    static_cast<double>(totalLivesLost) / runs, share(livesLost[0]), share(livesLost[1]),
+                    share(livesLost[2]), share(livesLost[3]));
+        std::printf("  power-ups per run:");
+        for (int type = 0; type < PowerUp::TYPE_COUNT; ++type) {
+            std::printf("%s %s %.2f", type ? "," : "", qPrintable(PowerUp::nameFor(static_cast<PowerUpType>(type))),
+                        static_cast<double>(powerUps[type]) / runs);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
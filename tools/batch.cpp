@@ -0,0 +1,138 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "HeadlessGame.h"
+#include "Level.h"
+#include "LevelManager.h"
+#include "PaddleController.h"
+#include "Profiler.h"
+
+namespace {
+
+template <typename T>
+T percentile(std::vector<T> values, double fraction)
+{
+    if (values.empty()) {
+        return T();
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+}
+
+} // namespace
+
+// Plays many complete games with a computer-controlled paddle on the installed level
+// set, spread over worker threads, and reports throughput and outcomes.
+// Needs no display, so balance changes can be load-tested on CI machines.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs Qt Arkanoid games headless in parallel");
+    parser.addHelpOption();
+    QCommandLineOption gamesOption({ "n", "games" }, "Number of games to play.", "count", "1000");
+    QCommandLineOption threadsOption({ "t", "threads" }, "Worker threads (default: one per core).", "count",
+                                     QString::number(QThread::idealThreadCount()));
+    QCommandLineOption seedOption("seed", "Seed of the first game; game i uses seed + i.", "seed", "1");
+    QCommandLineOption minutesOption("max-minutes", "Game-time limit per game in minutes.", "minutes", "30");
+    QCommandLineOption packOption("pack", "Also play the user level pack in <dir>.", "dir");
+    QCommandLineOption controllerOption("controller", "Paddle controller: autopilot or follow.", "name", "autopilot");
+    parser.addOptions({ gamesOption, threadsOption, seedOption, minutesOption, packOption, controllerOption });
+    parser.process(app);
+    
+    const QString controller = parser.value(controllerOption);
+    if (controller != "autopilot" && controller != "follow") {
+        std::fprintf(stderr, "batch: unknown controller '%s'\n", qPrintable(controller));
+        return 1;
+    }
+    
+    // Only the summary goes to stdout
+    QLoggingCategory::setFilterRules("default.debug=false");
+    Profiler::instance().setEnabled(false);
+    
+    LevelManager levelManager;
+    for (const QString &pack : parser.values(packOption)) {
+        levelManager.addPackDirectory(pack);
+    }
+    if (!levelManager.loadLevels()) {
+        std::fprintf(stderr, "batch: no levels found\n");
+        return 1;
+    }
+    
+    std::vector<std::shared_ptr<const Level>> levels;
+    for (int id = 1; id <= levelManager.totalLevels(); ++id) {
+        std::shared_ptr<const Level> level = levelManager.level(id);
+        if (!level) {
+            std::fprintf(stderr, "batch: could not load level %d\n", id);
+            return 1;
+        }
+        levels.push_back(level);
+    }
+    
+    const int games = qMax(1, parser.value(gamesOption).toInt());
+    const int threads = qMax(1, parser.value(threadsOption).toInt());
+    const quint32 firstSeed = parser.value(seedOption).toUInt();
+    
+    const quint64 maxTicks = static_cast<quint64>(parser.value(minutesOption).toDouble() * 60.0 *
+                                                  GameWorld::DEFAULT_TICK_RATE);
+    
+    std::vector<quint32> seeds(games);
+    for (int i = 0; i < games; ++i) {
+        seeds[i] = firstSeed + static_cast<quint32>(i);
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    QElapsedTimer timer;
+    timer.start();
+    // Controllers keep state between ticks, so every game gets its own
+    const QList<GameResult> results = QtConcurrent::blockingMapped<QList<GameResult>>(
+        &pool, seeds, [&](quint32 seed) {
+            std::unique_ptr<PaddleController> paddle;
+            if (controller == "follow") {
+                paddle = std::make_unique<BallFollower>();
+            } else {
+                paddle = std::make_unique<Autopilot>();
+            }
+            HeadlessGame game(levels, [&paddle](const GameWorld &world) { return paddle->update(world); });
+            game.setMaxTicks(maxTicks);
+            return game.play(seed);
+        });
+    const double seconds = qMax<qint64>(timer.nsecsElapsed(), 1) / 1e9;
+    
+    quint64 totalTicks = 0;
+    int outcomes[3] = { 0, 0, 0 };
+    std::vector<int> scores;
+    std::vector<int> cleared;
+    std::vector<double> minutes;
+    for (const GameResult &result : results) {
+        totalTicks += result.ticks;
+        ++outcomes[static_cast<int>(result.outcome)];
+        scores.push_back(result.score);
+        cleared.push_back(result.levelsCleared());
+        minutes.push_back(result.ticks / 60.0 / GameWorld::DEFAULT_TICK_RATE);
+    }
+    
+    auto share = [games](int count) { return 100.0 * count / games; };
+    std::printf("batch: %d games, %d levels, %d threads, %s, %.2f s\n", games, static_cast<int>(levels.size()),
+                threads, qPrintable(controller), seconds);
+    std::printf("throughput: %.0f ticks/s, %.1f games/s\n", totalTicks / seconds, games / seconds);
+    std::printf("outcomes: won %d (%.1f%%), lost %d (%.1f%%), timed out %d (%.1f%%)\n",
+                outcomes[0], share(outcomes[0]), outcomes[1], share(outcomes[1]), outcomes[2], share(outcomes[2]));
+    std::printf("levels cleared: p50 %d, p90 %d, max %d\n",
+                percentile(cleared, 0.5), percentile(cleared, 0.9), percentile(cleared, 1.0));
+    std::printf("score: p50 %d, p90 %d, max %d\n",
+                percentile(scores, 0.5), percentile(scores, 0.9), percentile(scores, 1.0));
+    std::printf("game length (game-time minutes): p50 %.1f, p90 %.1f, max %.1f\n",
+                percentile(minutes, 0.5), percentile(minutes, 0.9), percentile(minutes, 1.0));
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSaveFile>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "Level.h"
+#include "LevelPack.h"
+
+// Offline level compiler: parses JSON levels (the authoring format) with the
+// game's own loader and writes them, in argument order, into a level pack
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compiles Qt Arkanoid JSON levels into a binary level pack");
+    parser.addHelpOption();
+    QCommandLineOption outputOption({ "o", "output" }, "Write the pack to <file>.", "file", "levels.pack");
+    parser.addOption(outputOption);
+    parser.addPositionalArgument("levels", "JSON level files, in play order.", "level.json...");
+    parser.process(app);
+    
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        parser.showHelp(1);
+    }
+    
+    std::vector<std::unique_ptr<Level>> levels;
+    std::vector<const Level *> pointers;
+    for (const QString &input : inputs) {
+        auto level = std::make_unique<Level>();
+        if (!level->loadFromJson(input)) {
+            std::fprintf(stderr, "levelc: could not load %s\n", qPrintable(input));
+            return 1;
+        }
+        pointers.push_back(level.get());
+        levels.push_back(std::move(level));
+    }
+    
+    QString error;
+    const QByteArray pack = LevelPack::compile(pointers, &error);
+    if (pack.isEmpty()) {
+        std::fprintf(stderr, "levelc: %s\n", qPrintable(error));
+        return 1;
+    }
+    
+    // Written atomically so an interrupted build never leaves a torn pack
+    QSaveFile output(parser.value(outputOption));
+    if (!output.open(QIODevice::WriteOnly) || output.write(pack) != pack.size() || !output.commit()) {
+        std::fprintf(stderr, "levelc: could not write %s\n", qPrintable(output.fileName()));
+        return 1;
+    }
+    
+    std::printf("levelc: %d levels, %d bytes -> %s\n", static_cast<int>(levels.size()),
+                static_cast<int>(pack.size()), qPrintable(output.fileName()));
+    return 0;
+}